@@ -751,6 +751,9 @@ class MultiperspectivePerceptronTAGE8KB(MultiperspectivePerceptronTAGE):
 
     statistical_corrector = MPP_StatisticalCorrector_8KB()
 
+class GSelectIndexFunction(Enum):
+    vals = ['Concat', 'Gshare', 'Skewed', 'Multiplicative']
+
 class GSelectBP (BranchPredictor):
     type = 'GSelectBP'
     cxx_class = 'GSelectBP'
@@ -758,4 +761,34 @@ class GSelectBP (BranchPredictor):
     PredictorSize = Param.Unsigned(1024, "Size of global predictor")
     PHTCtrBits = Param.Unsigned(2, "Bits per counter")
     globalHistoryBits = Param.Unsigned(8, "Bits of the global history.")
-
+    foldedHistoryBits = Param.Unsigned(0,
+        "Bits the global history is folded to for indexing, 0 to not fold. "
+        "Folding allows globalHistoryBits of up to 1024")
+    indexFunction = Param.GSelectIndexFunction('Concat',
+        "How history and PC are combined into the PHT index: Concat "
+        "(history above PC bits), Gshare (history XORed onto the PC), "
+        "Skewed (Seznec skewing function) or Multiplicative (Fibonacci hash)")
+    threadHashedIndex = Param.Bool(False,
+        "XOR a hash of the thread ID into the PHT index so SMT threads "
+        "running the same code do not share counters")
+    taggedWays = Param.Unsigned(0,
+        "Ways of a tagged set-associative PHT of PredictorSize entries "
+        "backed by a bimodal table, 0 for the direct-mapped PHT")
+    tagBits = Param.Unsigned(8, "Partial tag bits per tagged PHT entry")
+    bimodalSize = Param.Unsigned(1024,
+        "Entries of the bimodal table behind the tagged PHT")
+    packedPHT = Param.Bool(False,
+        "Store the PHT counters bit-packed, 64/PHTCtrBits per 64-bit word")
+    specializedKernels = Param.Bool(True,
+        "Use a compile-time specialised core when the geometry has one")
+    historyPoolSize = Param.Unsigned(256,
+        "BPHistory records pooled per thread before falling back to the heap")
+    profileEntries = Param.Unsigned(0,
+        "Static branches tracked by the per-PC misprediction profiler, "
+        "0 to disable it")
+    profileTopN = Param.Unsigned(64, "Worst branches written to the profile")
+    profileFormat = Param.String("csv", "Profile output format, csv or json")
+    callLog = Param.Bool(False,
+        "Record every predictor call to <name>.calllog for offline replay")
+    callLogBufferSize = Param.Unsigned(65536,
+        "Records per call log buffer; two are written alternately")
@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cpu/pred/bp_call_log.hh"
+
+#include "base/logging.hh"
+#include "base/output.hh"
+
+BPCallLog::BPCallLog(OutputStream *os, const BPCallLogHeader &header,
+                     size_t buffer_records)
+    : os(os), bufferRecords(buffer_records), active(0), fill(0),
+      nextHistory(0), handedOff(0), writerStalls(0),
+      pending(nullptr), pendingRecords(0), stopping(false)
+{
+    fatal_if(bufferRecords == 0, "The call log needs a non-zero buffer.\n");
+    buffers[0].resize(bufferRecords);
+    buffers[1].resize(bufferRecords);
+    os->stream()->write(reinterpret_cast<const char *>(&header),
+                        sizeof(header));
+    writer = std::thread([this]() { writerLoop(); });
+}
+
+BPCallLog::~BPCallLog()
+{
+    if (os) {
+        if (fill) {
+            handOff();
+        }
+        shutdown();
+    }
+}
+
+void
+BPCallLog::handOff()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    if (pending) {
+        writerStalls++;
+        cond.wait(guard, [this]() { return pending == nullptr; });
+    }
+    pending = buffers[active].data();
+    pendingRecords = fill;
+    guard.unlock();
+    cond.notify_all();
+
+    handedOff += fill;
+    active ^= 1;
+    fill = 0;
+}
+
+void
+BPCallLog::finish(uint64_t final_digest)
+{
+    assert(os);
+    record(BPCallEnd, 0, final_digest, 0, 0);
+    if (fill) {
+        handOff();
+    }
+    shutdown();
+}
+
+void
+BPCallLog::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    cond.notify_all();
+    writer.join();
+    fatal_if(!*os->stream(), "Failed to write the branch predictor call "
+             "log.\n");
+    simout.close(os);
+    os = nullptr;
+}
+
+void
+BPCallLog::writerLoop()
+{
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        cond.wait(guard, [this]() { return pending || stopping; });
+        if (!pending) {
+            return;
+        }
+        const BPCallRecord *buf = pending;
+        const size_t records = pendingRecords;
+
+        // The simulation only touches the other buffer meanwhile.
+        guard.unlock();
+        os->stream()->write(reinterpret_cast<const char *>(buf),
+                            records * sizeof(BPCallRecord));
+        guard.lock();
+
+        pending = nullptr;
+        cond.notify_all();
+    }
+}
@@ -0,0 +1,211 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Recorder for the calls a direction predictor receives from BPredUnit,
+ * and the layout of the binary log it writes. Records are in host byte
+ * order.
+ */
+
+#ifndef __CPU_PRED_BP_CALL_LOG_HH__
+#define __CPU_PRED_BP_CALL_LOG_HH__
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base/types.hh"
+
+class OutputStream;
+
+/** Predictor calls recorded in the log. */
+enum BPCallOp : uint8_t
+{
+    BPCallLookup,
+    BPCallUncondBranch,
+    BPCallBTBUpdate,
+    BPCallUpdate,
+    BPCallSquash,
+    BPCallWarm,
+    /** Last record; pc holds the digest of the final predictor state. */
+    BPCallEnd,
+    NumBPCallOps
+};
+
+inline const char *
+bpCallOpName(unsigned op)
+{
+    static const char *const names[] =
+        {"lookup", "uncondBranch", "btbUpdate", "update", "squash", "warm",
+         "end"};
+    return op < NumBPCallOps ? names[op] : "unknown";
+}
+
+/** Bits of BPCallRecord::flags. */
+enum BPCallFlags : uint8_t
+{
+    /** Branch outcome; for lookup() the prediction that was returned. */
+    BPCallTaken = 1,
+    /** update() called for a misprediction. */
+    BPCallSquashed = 2,
+    /** warm() of a conditional branch. */
+    BPCallConditional = 4
+};
+
+/**
+ * Start of the log: the predictor geometry the calls have to be
+ * replayed on and the digest of its state when recording began, which
+ * differs from a fresh predictor's if it was restored from a
+ * checkpoint. The header is a multiple of 8 bytes so the records that
+ * follow stay aligned.
+ */
+struct BPCallLogHeader
+{
+    /** "GSBPCALL". */
+    char magic[8];
+    uint32_t version;
+    uint32_t numThreads;
+    uint32_t predictorSize;
+    uint32_t phtCtrBits;
+    uint32_t globalHistoryBits;
+    uint32_t foldedHistoryBits;
+    uint32_t indexFunction;
+    uint32_t instShiftAmt;
+    uint32_t threadHashedIndex;
+    /** Tagged PHT geometry; taggedWays is 0 for the direct-mapped PHT. */
+    uint32_t taggedWays;
+    uint32_t tagBits;
+    uint32_t bimodalSize;
+    uint64_t startDigest;
+};
+
+static const char BPCallLogMagic[8] = {'G', 'S', 'B', 'P', 'C', 'A', 'L', 'L'};
+static const uint32_t BPCallLogVersion = 3;
+
+/**
+ * One predictor call. bp_history pointers are replaced by a sequence
+ * number handed out when lookup() or uncondBranch() created the record,
+ * so a replay can map them onto its own history records.
+ */
+struct BPCallRecord
+{
+    uint64_t pc;
+    uint32_t history;
+    uint8_t op;
+    uint8_t tid;
+    uint8_t flags;
+    uint8_t pad;
+};
+
+static_assert(sizeof(BPCallLogHeader) == 64, "BPCallLogHeader layout");
+static_assert(sizeof(BPCallRecord) == 16, "BPCallRecord layout");
+
+/**
+ * Writes BPCallRecords to a file without holding up the simulation.
+ * Records go into one of two buffers; when it fills up it is handed to
+ * a writer thread and recording carries on in the other one. The
+ * simulation only waits if the writer has not finished the previous
+ * buffer by the time the current one is full.
+ */
+class BPCallLog
+{
+  public:
+    /**
+     * @param os Binary output file; the log closes it.
+     * @param header Written before any record.
+     * @param buffer_records Records per buffer.
+     */
+    BPCallLog(OutputStream *os, const BPCallLogHeader &header,
+              size_t buffer_records);
+
+    /** Flushes and closes the log if finish() was not called. */
+    ~BPCallLog();
+
+    /** Sequence number for a newly created history record. */
+    uint32_t newHistory() { return nextHistory++; }
+
+    void
+    record(BPCallOp op, ThreadID tid, Addr pc, uint32_t history,
+           uint8_t flags)
+    {
+        BPCallRecord &rec = buffers[active][fill];
+        rec.pc = pc;
+        rec.history = history;
+        rec.op = op;
+        rec.tid = tid;
+        rec.flags = flags;
+        rec.pad = 0;
+        if (++fill == bufferRecords) {
+            handOff();
+        }
+    }
+
+    /**
+     * Append the end record carrying the final state digest, write out
+     * everything and close the file. Nothing may be recorded after it.
+     */
+    void finish(uint64_t final_digest);
+
+    /** Records written so far, including those still buffered. */
+    uint64_t records() const { return handedOff + fill; }
+
+    /** Times recording had to wait for the writer. */
+    uint64_t stalls() const { return writerStalls; }
+
+  private:
+    /** Give the full buffer to the writer and switch to the other. */
+    void handOff();
+
+    /** Stop the writer after it has drained and close the file. */
+    void shutdown();
+
+    void writerLoop();
+
+    OutputStream *os;
+    const size_t bufferRecords;
+    std::vector<BPCallRecord> buffers[2];
+    unsigned active;
+    size_t fill;
+    uint32_t nextHistory;
+    uint64_t handedOff;
+    uint64_t writerStalls;
+
+    std::thread writer;
+    std::mutex lock;
+    std::condition_variable cond;
+    /** Buffer the writer is to write or is writing, if any. */
+    const BPCallRecord *pending;
+    size_t pendingRecords;
+    bool stopping;
+};
+
+#endif // __CPU_PRED_BP_CALL_LOG_HH__
@@ -0,0 +1,160 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A bounded per-PC profile of branch predictions and mispredictions.
+ */
+
+#include "cpu/pred/branch_profiler.hh"
+
+#include <algorithm>
+#include <ios>
+
+#include "base/intmath.hh"
+
+BranchProfiler::BranchProfiler(unsigned capacity)
+    : table(1u << ceilLog2(capacity), Entry{EmptyPC, 0, 0, 0}),
+      slotMask(table.size() - 1),
+      maxTracked(table.size() - std::max<size_t>(table.size() / 8, 1)),
+      tracked(0), maxProbe(0), filterShift(0),
+      untrackedLookups(0), untrackedMispredicts(0), untrackedSquashes(0)
+{
+}
+
+unsigned
+BranchProfiler::findSlot(Addr pc, uint64_t hash)
+{
+    if (!saturatedFilter.empty()) {
+        const uint64_t bit = hash >> filterShift;
+        if (!(saturatedFilter[bit / 64] >> (bit % 64) & 1)) {
+            return Untracked;
+        }
+    }
+
+    // At least one slot is always kept free, so this terminates.
+    unsigned slot = (hash >> 32) & slotMask;
+    for (unsigned probe = 0; ; probe++) {
+        Entry &entry = table[slot];
+        if (entry.pc == pc) {
+            return slot;
+        }
+        if (entry.pc == EmptyPC) {
+            if (tracked == maxTracked) {
+                return Untracked;
+            }
+            tracked++;
+            entry.pc = pc;
+            maxProbe = std::max(maxProbe, probe);
+            if (tracked == maxTracked) {
+                buildSaturatedFilter();
+            }
+            return slot;
+        }
+        if (probe == maxProbe && tracked == maxTracked) {
+            // Nothing is claimed any more, and no tracked branch is
+            // further than this from its home slot.
+            return Untracked;
+        }
+        slot = (slot + 1) & slotMask;
+    }
+}
+
+void
+BranchProfiler::buildSaturatedFilter()
+{
+    // Eight bits per slot: about one untracked branch in nine still
+    // has to probe.
+    const unsigned filter_bits = table.size() * 8;
+    filterShift = 64 - floorLog2(filter_bits);
+    saturatedFilter.assign((filter_bits + 63) / 64, 0);
+    for (const Entry &entry : table) {
+        if (entry.pc != EmptyPC) {
+            const uint64_t bit =
+                (entry.pc * HashMultiplier) >> filterShift;
+            saturatedFilter[bit / 64] |= uint64_t(1) << (bit % 64);
+        }
+    }
+}
+
+std::vector<BranchProfiler::Entry>
+BranchProfiler::top(unsigned n) const
+{
+    std::vector<Entry> entries;
+    entries.reserve(tracked);
+    for (const Entry &entry : table) {
+        if (entry.pc != EmptyPC) {
+            entries.push_back(entry);
+        }
+    }
+    auto worse = [](const Entry &a, const Entry &b) {
+        return a.mispredicts != b.mispredicts ?
+            a.mispredicts > b.mispredicts : a.pc < b.pc;
+    };
+    if (n < entries.size()) {
+        std::partial_sort(entries.begin(), entries.begin() + n,
+                          entries.end(), worse);
+        entries.resize(n);
+    } else {
+        std::sort(entries.begin(), entries.end(), worse);
+    }
+    return entries;
+}
+
+void
+BranchProfiler::dumpCSV(std::ostream &os, unsigned n) const
+{
+    os << "pc,lookups,mispredicts,squashes\n";
+    for (const Entry &entry : top(n)) {
+        os << "0x" << std::hex << entry.pc << std::dec << ","
+           << entry.lookups << "," << entry.mispredicts << ","
+           << entry.squashes << "\n";
+    }
+    os << "untracked," << untrackedLookups << "," << untrackedMispredicts
+       << "," << untrackedSquashes << "\n";
+}
+
+void
+BranchProfiler::dumpJSON(std::ostream &os, unsigned n) const
+{
+    os << "{\n  \"tracked\": " << tracked << ",\n"
+       << "  \"capacity\": " << maxTracked << ",\n"
+       << "  \"untracked\": {\"lookups\": " << untrackedLookups
+       << ", \"mispredicts\": " << untrackedMispredicts
+       << ", \"squashes\": " << untrackedSquashes << "},\n"
+       << "  \"branches\": [";
+    const char *sep = "\n";
+    for (const Entry &entry : top(n)) {
+        os << sep << "    {\"pc\": \"0x" << std::hex << entry.pc << std::dec
+           << "\", \"lookups\": " << entry.lookups
+           << ", \"mispredicts\": " << entry.mispredicts
+           << ", \"squashes\": " << entry.squashes << "}";
+        sep = ",\n";
+    }
+    os << "\n  ]\n}\n";
+}
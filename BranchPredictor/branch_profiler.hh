@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A bounded per-PC profile of branch predictions and mispredictions.
+ */
+
+#ifndef __CPU_PRED_BRANCH_PROFILER_HH__
+#define __CPU_PRED_BRANCH_PROFILER_HH__
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "base/types.hh"
+
+/**
+ * Counts predictions, mispredictions and squashes per static branch in
+ * a fixed-size open-addressing hash table, so it can stay enabled for
+ * whole runs. Once the table is 7/8 full (at least one slot is always
+ * kept free so probes terminate) new branches are no longer
+ * tracked; their events are still counted in aggregate so the report
+ * shows how much was missed.
+ *
+ * A full table is the common case on large workloads, and there most
+ * lookups are of untracked branches. Those would otherwise probe the
+ * long clusters of a 7/8-full table on every prediction, so a bit
+ * filter of the tracked PCs is built when the table fills and turns
+ * most of them away after one load; the rest probe no further than
+ * the longest probe any tracked branch needed.
+ *
+ * lookup() returns a slot handle that the predictor keeps in its
+ * per-branch history; mispredict() and squash() take that handle, so
+ * each branch is hashed once however many events it sees.
+ */
+class BranchProfiler
+{
+  public:
+    /** Handle of a branch that could not be tracked. */
+    static const unsigned Untracked = ~0u;
+
+    struct Entry
+    {
+        Addr pc;
+        uint64_t lookups;
+        uint64_t mispredicts;
+        uint64_t squashes;
+    };
+
+    /**
+     * @param capacity Number of hash table slots, rounded up to a power
+     *                 of 2.
+     */
+    explicit BranchProfiler(unsigned capacity);
+
+    /** Count a prediction of the branch at pc. */
+    unsigned
+    lookup(Addr pc)
+    {
+        // Most branches are found in their home slot; only the rest
+        // take the out-of-line probe.
+        const uint64_t hash = pc * HashMultiplier;
+        const unsigned home = (hash >> 32) & slotMask;
+        const unsigned slot =
+            table[home].pc == pc ? home : findSlot(pc, hash);
+        if (slot == Untracked) {
+            untrackedLookups++;
+        } else {
+            table[slot].lookups++;
+        }
+        return slot;
+    }
+
+    /** Count a misprediction of a branch returned by lookup(). */
+    void
+    mispredict(unsigned slot)
+    {
+        if (slot == Untracked) {
+            untrackedMispredicts++;
+        } else {
+            table[slot].mispredicts++;
+        }
+    }
+
+    /** Count a wrong-path squash of a branch returned by lookup(). */
+    void
+    squash(unsigned slot)
+    {
+        if (slot == Untracked) {
+            untrackedSquashes++;
+        } else {
+            table[slot].squashes++;
+        }
+    }
+
+    /** The n branches with the most mispredictions, worst first. */
+    std::vector<Entry> top(unsigned n) const;
+
+    /** Write the n worst branches as CSV. */
+    void dumpCSV(std::ostream &os, unsigned n) const;
+
+    /** Write the n worst branches and the table summary as JSON. */
+    void dumpJSON(std::ostream &os, unsigned n) const;
+
+  private:
+    /** Find or claim the slot for pc; Untracked if the table is full. */
+    unsigned findSlot(Addr pc, uint64_t hash);
+
+    /** Set a filter bit for every tracked PC, once the table is full. */
+    void buildSaturatedFilter();
+
+    static const Addr EmptyPC = ~Addr(0);
+    /** Fibonacci hashing multiplier of the home slot and filter bit. */
+    static const uint64_t HashMultiplier = ULL(0x9e3779b97f4a7c15);
+
+    std::vector<Entry> table;
+    const unsigned slotMask;
+    const unsigned maxTracked;
+    unsigned tracked;
+    /** Longest probe of any tracked branch, past its home slot. */
+    unsigned maxProbe;
+
+    /** Bits of tracked PCs' hashes; empty until the table is full. */
+    std::vector<uint64_t> saturatedFilter;
+    /** Shift taking a PC's hash to its filter bit. */
+    unsigned filterShift;
+
+    uint64_t untrackedLookups;
+    uint64_t untrackedMispredicts;
+    uint64_t untrackedSquashes;
+};
+
+#endif // __CPU_PRED_BRANCH_PROFILER_HH__
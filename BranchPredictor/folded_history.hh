@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A long global history kept in a circular buffer together with an
+ * incrementally folded copy used for indexing.
+ */
+
+#ifndef __CPU_PRED_FOLDED_HISTORY_HH__
+#define __CPU_PRED_FOLDED_HISTORY_HH__
+
+#include <cstdint>
+#include <vector>
+
+#include "base/intmath.hh"
+
+/**
+ * Global history of up to thousands of branches. The outcomes live in a
+ * circular buffer, newest at ptr, and the history is also kept XOR-folded
+ * down to foldedBits bits the way TAGE folds its histories: every push
+ * shifts the new outcome in, cancels the outcome that just aged out of
+ * the history and wraps the bit that left the top. Producing an index
+ * from the folded value costs the same whatever the history length.
+ *
+ * A checkpoint is just the buffer position and the folded value. Older
+ * outcomes are not overwritten until the buffer wraps, so a checkpoint
+ * can be restored as long as fewer than SpeculativeSlack outcomes were
+ * pushed after it was taken.
+ */
+class FoldedHistory
+{
+  public:
+    /** Outcomes that may be pushed past a live checkpoint. */
+    static const unsigned SpeculativeSlack = 4096;
+
+    /** The longest history supported. */
+    static const unsigned MaxHistoryBits = 1024;
+
+    FoldedHistory(unsigned history_bits, unsigned folded_bits)
+        : outcomes(1u << ceilLog2(history_bits + SpeculativeSlack), 0),
+          bufferMask(outcomes.size() - 1),
+          ptr(0),
+          historyBits(history_bits),
+          foldedBits(folded_bits),
+          outPoint(history_bits % folded_bits),
+          foldedMask((1u << folded_bits) - 1),
+          folded(0)
+    {}
+
+    /** Shift a branch outcome into the history. */
+    void
+    push(bool taken)
+    {
+        ptr = (ptr + 1) & bufferMask;
+        outcomes[ptr] = taken;
+        const unsigned aged_out = outcomes[(ptr - historyBits) & bufferMask];
+        folded = (folded << 1) | taken;
+        folded ^= aged_out << outPoint;
+        folded ^= folded >> foldedBits;
+        folded &= foldedMask;
+    }
+
+    /** Force the newest outcome to not taken. */
+    void
+    clearNewest()
+    {
+        folded ^= outcomes[ptr];
+        outcomes[ptr] = 0;
+    }
+
+    /** The history folded to foldedBits bits. */
+    unsigned value() const { return folded; }
+
+    /** Buffer position of the newest outcome, for checkpointing. */
+    unsigned position() const { return ptr; }
+
+    /**
+     * Roll back to a checkpoint taken with position() and value().
+     */
+    void
+    restore(unsigned position, unsigned folded_value)
+    {
+        ptr = position;
+        folded = folded_value;
+    }
+
+    /** The outcome buffer, for checkpointing. */
+    const std::vector<uint8_t> &buffer() const { return outcomes; }
+
+    /**
+     * Load a checkpointed state. The buffer must come from a history of
+     * the same length.
+     */
+    void
+    load(const std::vector<uint8_t> &buffer, unsigned position,
+         unsigned folded_value)
+    {
+        outcomes = buffer;
+        restore(position, folded_value);
+    }
+
+  private:
+    std::vector<uint8_t> outcomes;
+    const unsigned bufferMask;
+    unsigned ptr;
+
+    const unsigned historyBits;
+    const unsigned foldedBits;
+    /** Position the aged-out outcome lands on in the folded value. */
+    const unsigned outPoint;
+    const unsigned foldedMask;
+    unsigned folded;
+};
+
+#endif // __CPU_PRED_FOLDED_HISTORY_HH__
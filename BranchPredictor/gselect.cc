@@ -32,38 +32,406 @@
 
 #include "cpu/pred/gselect.hh"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+
+#include "base/cprintf.hh"
 #include "base/intmath.hh"
 #include "base/bitfield.hh"
 #include "base/logging.hh"
+#include "base/output.hh"
 #include "base/trace.hh"
 #include "debug/Fetch.hh"
 #include "debug/Mispredict.hh"
 #include "debug/GSDebug.hh"
+#include "sim/core.hh"
+#include "sim/serialize.hh"
 
 
 GSelectBP::GSelectBP(const GSelectBPParams &params)
     : BPredUnit(params),
       globalHistoryReg(params.numThreads, 0),
       globalHistoryBits(params.globalHistoryBits),
+      foldedHistoryBits(params.foldedHistoryBits),
       phtCtrBits(params.PHTCtrBits),
       predictorSize(params.PredictorSize),
-      finalCounters(predictorSize, SatCounter8(phtCtrBits))
+      indexFunction(params.indexFunction),
+      threadHashedIndex(params.threadHashedIndex),
+      packedPHT(params.packedPHT),
+      taggedWays(params.taggedWays),
+      profileTopN(params.profileTopN),
+      profileJSON(params.profileFormat == "json"),
+      recordCalls(params.callLog),
+      callLogBufferSize(params.callLogBufferSize),
+      gselectStats(this)
 {
     if(!isPowerOf2(predictorSize)) {
         fatal("Invalid predictor size.\n");
     }
+    indexBits = ceilLog2(predictorSize);
+    fatal_if(indexFunction == Enums::Skewed && indexBits < 2,
+             "The skewed index function needs at least 4 PHT entries.\n");
+    fatal_if(indexFunction == Enums::Multiplicative && indexBits < 1,
+             "The multiplicative index function needs at least 2 PHT "
+             "entries.\n");
+    fatal_if(threadHashedIndex && indexBits < 1,
+             "The thread-hashed index needs at least 2 PHT entries.\n");
+    if (foldedHistoryBits) {
+        fatal_if(foldedHistoryBits > indexBits || foldedHistoryBits >= 32,
+                 "foldedHistoryBits (%d) does not fit in the %d-bit PHT "
+                 "index.\n", foldedHistoryBits, indexBits);
+        fatal_if(globalHistoryBits == 0 ||
+                 globalHistoryBits > FoldedHistory::MaxHistoryBits,
+                 "globalHistoryBits must be between 1 and %d.\n",
+                 FoldedHistory::MaxHistoryBits);
+        foldedHistories.init(params.numThreads, globalHistoryBits,
+                             foldedHistoryBits);
+    } else {
+        fatal_if(globalHistoryBits > indexBits,
+                 "globalHistoryBits (%d) does not fit in the %d-bit PHT "
+                 "index; set foldedHistoryBits to fold longer histories.\n",
+                 globalHistoryBits, indexBits);
+    }
+
+    fatal_if(packedPHT && taggedWays,
+             "packedPHT and the tagged PHT cannot be combined.\n");
+    if (packedPHT) {
+        packedCounters = PackedSatCounterTable(predictorSize, phtCtrBits);
+    } else if (taggedWays) {
+        taggedPHT = TaggedPHT(predictorSize, taggedWays, params.tagBits,
+                              phtCtrBits, params.bimodalSize);
+    } else {
+        if (params.specializedKernels && !foldedHistoryBits &&
+                indexFunction == Enums::Concat && !threadHashedIndex) {
+            kernel = makeGSelectKernel(predictorSize, globalHistoryBits,
+                                       phtCtrBits, instShiftAmt);
+        }
+        if (!kernel) {
+            finalCounters.assign(predictorSize, SatCounter8(phtCtrBits));
+        }
+    }
+    if (params.historyPoolSize == 0) {
+        fatal("GSelectBP needs a non-zero history pool size.\n");
+    }
+    historyArenas.init(params.numThreads, params.historyPoolSize);
+    if (params.profileEntries) {
+        fatal_if(params.profileFormat != "csv" &&
+                 params.profileFormat != "json",
+                 "Unknown profile format '%s'.\n", params.profileFormat);
+        profiler.reset(new BranchProfiler(params.profileEntries));
+        registerExitCallback([this]() { dumpProfile(); });
+        Stats::registerDumpCallback([this]() { dumpProfile(); });
+    }
+    if (recordCalls) {
+        fatal_if(params.numThreads > 256,
+                 "The call log records at most 256 threads.\n");
+        registerExitCallback([this]() {
+            if (callLog) {
+                callLog->finish(stateDigest());
+                callLog.reset();
+            }
+        });
+    }
     globalHistoryMask = mask(globalHistoryBits);
     DPRINTF(GSDebug, "The global history mask is: %d\n", globalHistoryMask);
-    branchAddressBits = ceilLog2(predictorSize) - globalHistoryBits;
+    const unsigned historyIndexBits =
+        foldedHistoryBits ? foldedHistoryBits : globalHistoryBits;
+    historyIndexMask = mask(historyIndexBits);
+    branchAddressBits = indexBits - historyIndexBits;
     branchAddressMask = mask(branchAddressBits);
+    indexMask = mask(indexBits);
     predictionThreshold = (ULL(1) << (phtCtrBits - 1)) - 1;
 }
 
+GSelectBP::GSelectBPStats::GSelectBPStats(GSelectBP *parent)
+    : Stats::Group(parent),
+      predictor(*parent),
+      ADD_STAT(historyAllocs, "Number of BPHistory records allocated"),
+      ADD_STAT(historyOverflows,
+               "Number of BPHistory records that overflowed the arena"),
+      ADD_STAT(historyPeakOccupancy,
+               "Peak number of in-flight BPHistory records on a thread"),
+      ADD_STAT(taggedHits, "Number of lookups predicted by a tagged PHT "
+               "entry"),
+      ADD_STAT(taggedAllocations, "Number of tagged PHT entries allocated")
+{
+}
+
+void
+GSelectBP::GSelectBPStats::preDumpStats()
+{
+    Stats::Group::preDumpStats();
+
+    uint64_t allocs = 0, overflows = 0;
+    size_t peak = 0;
+    for (size_t tid = 0; tid < predictor.historyArenas.size(); tid++) {
+        const HistoryArena<BPHistory> &arena = predictor.historyArenas[tid];
+        allocs += arena.allocations();
+        overflows += arena.overflowCount();
+        peak = std::max(peak, arena.peakOccupancy());
+    }
+    historyAllocs = allocs;
+    historyOverflows = overflows;
+    historyPeakOccupancy = peak;
+}
+
+void
+GSelectBP::GSelectBPStats::resetStats()
+{
+    Stats::Group::resetStats();
+
+    for (size_t tid = 0; tid < predictor.historyArenas.size(); tid++) {
+        predictor.historyArenas[tid].resetCounts();
+    }
+}
+
+GSelectBP::BPHistory *
+GSelectBP::allocHistory(ThreadID tid)
+{
+    BPHistory *history = historyArenas[tid].allocate();
+    return history ? history : new BPHistory;
+}
+
+void
+GSelectBP::freeHistory(ThreadID tid, BPHistory *history)
+{
+    HistoryArena<BPHistory> &arena = historyArenas[tid];
+    if (arena.owns(history)) {
+        arena.release(history);
+    } else {
+        delete history;
+    }
+}
+
+uint8_t
+GSelectBP::counterValue(unsigned idx) const
+{
+    if (kernel) {
+        return kernel->read(idx);
+    }
+    if (taggedWays) {
+        return taggedPHT.counter(idx);
+    }
+    return packedPHT ? packedCounters.read(idx) : (uint8_t)finalCounters[idx];
+}
+
+void
+GSelectBP::setCounterValue(unsigned idx, uint8_t val)
+{
+    if (kernel) {
+        kernel->write(idx, val);
+    } else if (taggedWays) {
+        taggedPHT.setCounter(idx, val);
+    } else if (packedPHT) {
+        packedCounters.write(idx, val);
+    } else {
+        finalCounters[idx] = SatCounter8(phtCtrBits, val);
+    }
+}
+
+void
+GSelectBP::trainCounter(unsigned idx, bool taken)
+{
+    if (packedPHT) {
+        packedCounters.update(idx, taken);
+    } else if (taken) {
+        finalCounters[idx]++;
+    } else {
+        finalCounters[idx]--;
+    }
+}
+
+void
+GSelectBP::trainTagged(ThreadID tid, Addr branch_addr, unsigned historyReg,
+                       bool taken)
+{
+    const Addr pc = branch_addr >> instShiftAmt;
+    const unsigned set =
+        taggedPHT.setOf(getGlobalIndex(tid, branch_addr, historyReg));
+    if (taggedPHT.update(set, taggedPHT.tagOf(pc, historyReg),
+                         taggedPHT.bimodalOf(pc), taken)) {
+        ++gselectStats.taggedAllocations;
+    }
+}
+
+/*
+ * Skewing function H from Seznec's skewed-associative caches, on n-bit
+ * values: the bits shift down by one and the top bit becomes the XOR of
+ * the old top and bottom bits. skewInverse() undoes it.
+ */
+static inline unsigned
+skew(unsigned y, unsigned n)
+{
+    return (y >> 1) | ((((y >> (n - 1)) ^ y) & 1) << (n - 1));
+}
+
+static inline unsigned
+skewInverse(unsigned y, unsigned n)
+{
+    return ((y << 1) & mask(n)) | (((y >> (n - 1)) ^ (y >> (n - 2))) & 1);
+}
+
+unsigned
+GSelectBP::getGlobalIndex(ThreadID tid, Addr branchAddr, unsigned historyReg)
+{
+    const Addr pc = branchAddr >> instShiftAmt;
+    const unsigned globalHistoryIdx = (historyReg & historyIndexMask);
+    unsigned finalIdx;
+    switch (indexFunction) {
+      case Enums::Concat:
+        finalIdx = (globalHistoryIdx << branchAddressBits) |
+            (pc & branchAddressMask);
+        break;
+      case Enums::Gshare:
+        finalIdx = (pc ^ (globalHistoryIdx << branchAddressBits)) & indexMask;
+        break;
+      case Enums::Skewed: {
+        const unsigned pcIdx = pc & indexMask;
+        const unsigned histIdx =
+            ((globalHistoryIdx << branchAddressBits) ^
+             (pc >> indexBits)) & indexMask;
+        finalIdx = skew(pcIdx, indexBits) ^
+            skewInverse(histIdx, indexBits) ^ histIdx;
+        break;
+      }
+      case Enums::Multiplicative: {
+        const uint64_t key = (uint64_t(globalHistoryIdx) << 32) ^ pc;
+        finalIdx = (key * ULL(0x9e3779b97f4a7c15)) >> (64 - indexBits);
+        break;
+      }
+      default:
+        panic("Unknown GSelectBP index function %d.\n", indexFunction);
+    }
+    if (threadHashedIndex) {
+        finalIdx ^= (uint32_t(tid) * 0x9e3779b9U) >> (32 - indexBits);
+    }
+    assert(finalIdx < predictorSize);
+    return finalIdx;
+}
+
+unsigned
+GSelectBP::currentHistory(ThreadID tid) const
+{
+    if (foldedHistoryBits) {
+        return foldedHistories[tid].value();
+    }
+    return globalHistoryReg[tid] & globalHistoryMask;
+}
+
+void
+GSelectBP::saveHistory(ThreadID tid, BPHistory *history) const
+{
+    history->globalHistoryReg = currentHistory(tid);
+    history->historyPtr =
+        foldedHistoryBits ? foldedHistories[tid].position() : 0;
+}
+
+void
+GSelectBP::restoreHistory(ThreadID tid, const BPHistory *history)
+{
+    if (foldedHistoryBits) {
+        foldedHistories[tid].restore(history->historyPtr,
+                                     history->globalHistoryReg);
+    } else {
+        globalHistoryReg[tid] = history->globalHistoryReg & globalHistoryMask;
+    }
+}
+
+void
+GSelectBP::dumpProfile()
+{
+    OutputStream *os = simout.create(
+        name() + (profileJSON ? ".profile.json" : ".profile.csv"));
+    if (profileJSON) {
+        profiler->dumpJSON(*os->stream(), profileTopN);
+    } else {
+        profiler->dumpCSV(*os->stream(), profileTopN);
+    }
+    simout.close(os);
+}
+
+void
+GSelectBP::startup()
+{
+    if (!recordCalls) {
+        return;
+    }
+    BPCallLogHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, BPCallLogMagic, sizeof(header.magic));
+    header.version = BPCallLogVersion;
+    header.numThreads = globalHistoryReg.size();
+    header.predictorSize = predictorSize;
+    header.phtCtrBits = phtCtrBits;
+    header.globalHistoryBits = globalHistoryBits;
+    header.foldedHistoryBits = foldedHistoryBits;
+    header.indexFunction = indexFunction;
+    header.threadHashedIndex = threadHashedIndex;
+    header.taggedWays = taggedWays;
+    header.tagBits = taggedPHT.tagWidth();
+    header.bimodalSize = taggedPHT.bimodalSize();
+    header.instShiftAmt = instShiftAmt;
+    header.startDigest = stateDigest();
+    callLog.reset(new BPCallLog(simout.create(name() + ".calllog", true),
+                                header, callLogBufferSize));
+}
+
+uint64_t
+GSelectBP::stateDigest() const
+{
+    // FNV-1a over the counters and histories.
+    uint64_t digest = ULL(0xcbf29ce484222325);
+    auto mix = [&digest](uint64_t val) {
+        for (unsigned byte = 0; byte < 8; byte++) {
+            digest = (digest ^ ((val >> (8 * byte)) & 0xff)) *
+                ULL(0x100000001b3);
+        }
+    };
+    for (unsigned idx = 0; idx < predictorSize; idx++) {
+        mix(counterValue(idx));
+    }
+    if (taggedWays) {
+        for (uint16_t tag : taggedPHT.rawTags()) {
+            mix(tag);
+        }
+        for (uint16_t useful : taggedPHT.rawUseful()) {
+            mix(useful);
+        }
+        for (uint8_t ctr : taggedPHT.rawBimodal()) {
+            mix(ctr);
+        }
+    }
+    for (unsigned tid = 0; tid < globalHistoryReg.size(); tid++) {
+        mix(globalHistoryReg[tid]);
+    }
+    for (unsigned tid = 0; tid < foldedHistories.size(); tid++) {
+        const FoldedHistory &folded = foldedHistories[tid];
+        mix(folded.position());
+        mix(folded.value());
+        for (uint8_t outcome : folded.buffer()) {
+            mix(outcome);
+        }
+    }
+    return digest;
+}
+
 void GSelectBP::uncondBranch(ThreadID tid, Addr pc, void * &bp_history)
 {
-    BPHistory *history = new BPHistory;
-    history->globalHistoryReg = globalHistoryReg[tid] & globalHistoryMask;
+    BPHistory *history = allocHistory(tid);
+    saveHistory(tid, history);
+    history->profileSlot =
+        profiler ? profiler->lookup(pc) : BranchProfiler::Untracked;
     history->finalPred = true;
+    if (callLog) {
+        history->callId = callLog->newHistory();
+        callLog->record(BPCallUncondBranch, tid, pc, history->callId,
+                        BPCallTaken);
+    }
     bp_history = static_cast<void*>(history);
     DPRINTF(GSDebug, "In uncondBranch. Global history register is: %d. Branch address = %d\n", globalHistoryReg[tid], pc);
     updateGlobalHistReg(tid, true);
@@ -73,9 +441,15 @@ void GSelectBP::squash(ThreadID tid, void *bp_history)
 {
     DPRINTF(GSDebug, "In squash. Global history register is (initially): %0x.\n", globalHistoryReg[tid]);
     BPHistory *history = static_cast<BPHistory*>(bp_history);
-    globalHistoryReg[tid] = history->globalHistoryReg & globalHistoryMask;
+    if (callLog) {
+        callLog->record(BPCallSquash, tid, 0, history->callId, 0);
+    }
+    restoreHistory(tid, history);
+    if (profiler) {
+        profiler->squash(history->profileSlot);
+    }
     DPRINTF(GSDebug, "In squash. Global history register is (finally): %0x.\n", globalHistoryReg[tid]);
-    delete history;
+    freeHistory(tid, history);
 }
 
 /*
@@ -91,18 +465,37 @@ bool
 GSelectBP::lookup(ThreadID tid, Addr branch_addr, void * &bp_history)
 {
     DPRINTF(GSDebug, "In lookup. Globalbranch address = %d\n, branchAddr: %d, ", branch_addr);
-    unsigned branchAddressIdx = ((branch_addr >> instShiftAmt) & branchAddressMask);
-    unsigned globalHistoryIdx = ((globalHistoryReg[tid]) & globalHistoryMask);
-    unsigned finalIdx =  (((globalHistoryIdx << branchAddressBits) | branchAddressIdx)) & mask(ceilLog2(predictorSize));
-
-    BPHistory *history = new BPHistory;
-
-    assert(finalIdx < predictorSize);
-    bool prediction = finalCounters[finalIdx] > predictionThreshold;
+    bool prediction;
+    if (kernel) {
+        prediction = kernel->predict(globalHistoryReg[tid], branch_addr);
+    } else if (taggedWays) {
+        const unsigned historyReg = currentHistory(tid);
+        const Addr pc = branch_addr >> instShiftAmt;
+        const unsigned set =
+            taggedPHT.setOf(getGlobalIndex(tid, branch_addr, historyReg));
+        const int way = taggedPHT.find(set,
+                                       taggedPHT.tagOf(pc, historyReg));
+        if (way != TaggedPHT::Miss) {
+            ++gselectStats.taggedHits;
+        }
+        prediction = taggedPHT.providerCounter(
+            set, way, taggedPHT.bimodalOf(pc)) > predictionThreshold;
+    } else {
+        unsigned finalIdx = getGlobalIndex(tid, branch_addr, currentHistory(tid));
+        prediction = counterValue(finalIdx) > predictionThreshold;
+    }
 
+    BPHistory *history = allocHistory(tid);
 
-    history->globalHistoryReg = globalHistoryReg[tid] & globalHistoryMask;
+    saveHistory(tid, history);
+    history->profileSlot =
+        profiler ? profiler->lookup(branch_addr) : BranchProfiler::Untracked;
     history->finalPred = prediction;
+    if (callLog) {
+        history->callId = callLog->newHistory();
+        callLog->record(BPCallLookup, tid, branch_addr, history->callId,
+                        prediction ? BPCallTaken : 0);
+    }
     bp_history = static_cast<void*>(history);
     updateGlobalHistReg(tid, prediction);
     return prediction;
@@ -111,7 +504,15 @@ GSelectBP::lookup(ThreadID tid, Addr branch_addr, void * &bp_history)
 void GSelectBP::btbUpdate(ThreadID tid, Addr branch_addr, void * &bp_history)
 {
     DPRINTF(GSDebug,"BTBUPDATE FUNCTION , globalHistoryReg Before mod: %0x\n",globalHistoryReg[tid]);
-    globalHistoryReg[tid] &= (globalHistoryMask & ~ULL(1));
+    if (callLog) {
+        callLog->record(BPCallBTBUpdate, tid, branch_addr,
+                        static_cast<BPHistory *>(bp_history)->callId, 0);
+    }
+    if (foldedHistoryBits) {
+        foldedHistories[tid].clearNewest();
+    } else {
+        globalHistoryReg[tid] &= (globalHistoryMask & ~ULL(1));
+    }
     DPRINTF(GSDebug,"BTBUPDATE FUNCTION , globalHistoryReg After mod: %0x\n",globalHistoryReg[tid]);
 }
 
@@ -121,27 +522,273 @@ void GSelectBP::update(ThreadID tid, Addr branch_addr, bool taken, void *bp_hist
     DPRINTF(GSDebug, "In update. branch address = %d\n", branch_addr);
     assert(bp_history);
     BPHistory *history = static_cast<BPHistory*>(bp_history);
+    if (callLog) {
+        callLog->record(BPCallUpdate, tid, branch_addr, history->callId,
+                        (taken ? BPCallTaken : 0) |
+                        (squashed ? BPCallSquashed : 0));
+    }
     if (squashed) {
-        globalHistoryReg[tid] = ((history->globalHistoryReg << 1) | taken) & globalHistoryMask;
+        if (profiler) {
+            profiler->mispredict(history->profileSlot);
+        }
+        restoreHistory(tid, history);
+        updateGlobalHistReg(tid, taken);
     	DPRINTF(GSDebug,"SQUASHED : UPDATE FUNCTION ENDS, HISTORY REG : %x\n",globalHistoryReg[tid]);
         return;
     }
-    unsigned branchAddressIdx = ((branch_addr >> instShiftAmt) & branchAddressMask);
-    unsigned globalHistoryIdx = (history->globalHistoryReg & globalHistoryMask);
-    unsigned finalIdx =  (((globalHistoryIdx << branchAddressBits) | branchAddressIdx)) & mask(ceilLog2(predictorSize));
-    assert(finalIdx < predictorSize);
-
-    if (taken) {
-        finalCounters[finalIdx]++;
+    if (kernel) {
+        kernel->train(history->globalHistoryReg, branch_addr, taken);
+    } else if (taggedWays) {
+        trainTagged(tid, branch_addr, history->globalHistoryReg, taken);
     } else {
-        finalCounters[finalIdx]--;
+        unsigned finalIdx = getGlobalIndex(tid, branch_addr, history->globalHistoryReg);
+        trainCounter(finalIdx, taken);
     }
-    delete history;
+    freeHistory(tid, history);
+}
+
+void
+GSelectBP::warm(ThreadID tid, Addr branch_addr, bool conditional, bool taken)
+{
+    if (callLog) {
+        callLog->record(BPCallWarm, tid, branch_addr, 0,
+                        (taken ? BPCallTaken : 0) |
+                        (conditional ? BPCallConditional : 0));
+    }
+    if (conditional) {
+        if (kernel) {
+            kernel->train(globalHistoryReg[tid], branch_addr, taken);
+        } else if (taggedWays) {
+            trainTagged(tid, branch_addr, currentHistory(tid), taken);
+        } else {
+            trainCounter(getGlobalIndex(tid, branch_addr, currentHistory(tid)),
+                         taken);
+        }
+    }
+    updateGlobalHistReg(tid, conditional ? taken : true);
 }
 
 void GSelectBP::updateGlobalHistReg(ThreadID tid, bool taken)
 {
+    if (foldedHistoryBits) {
+        foldedHistories[tid].push(taken);
+        return;
+    }
     globalHistoryReg[tid] = taken ? (globalHistoryReg[tid] << 1) | 1 :
                                (globalHistoryReg[tid] << 1);
     globalHistoryReg[tid] &= globalHistoryMask;
-}
\ No newline at end of file
+}
+
+namespace
+{
+
+/**
+ * Header of the PHT file written next to a checkpoint. The counters
+ * follow as 64-bit words in PackedSatCounterTable layout, storageBits
+ * per counter, in host byte order. The header is a multiple of 8 bytes
+ * so the words are aligned in a mapping of the file.
+ */
+struct PHTFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t ctrBits;
+    uint32_t storageBits;
+    uint32_t entries;
+    uint64_t words;
+};
+
+const char PHTFileMagic[8] = {'G', 'S', 'E', 'L', 'P', 'H', 'T', '\0'};
+const uint32_t PHTFileVersion = 1;
+
+/** Narrowest packed counter width that holds ctr_bits. */
+unsigned
+storageBitsFor(unsigned ctr_bits)
+{
+    return 1u << ceilLog2(ctr_bits);
+}
+
+} // anonymous namespace
+
+void
+GSelectBP::serialize(CheckpointOut &cp) const
+{
+    const unsigned indexFunctionId = indexFunction;
+    SERIALIZE_SCALAR(predictorSize);
+    SERIALIZE_SCALAR(phtCtrBits);
+    SERIALIZE_SCALAR(globalHistoryBits);
+    SERIALIZE_SCALAR(foldedHistoryBits);
+    SERIALIZE_SCALAR(indexFunctionId);
+    SERIALIZE_SCALAR(threadHashedIndex);
+    const unsigned tagBits = taggedPHT.tagWidth();
+    const unsigned bimodalSize = taggedPHT.bimodalSize();
+    SERIALIZE_SCALAR(taggedWays);
+    SERIALIZE_SCALAR(tagBits);
+    SERIALIZE_SCALAR(bimodalSize);
+    std::vector<unsigned> histories(globalHistoryReg.size());
+    for (unsigned tid = 0; tid < histories.size(); tid++) {
+        histories[tid] = globalHistoryReg[tid];
+    }
+    arrayParamOut(cp, "globalHistoryReg", histories);
+
+    // Write the counters packed, converting from the live storage unless
+    // it already is the packed layout.
+    const std::string phtFile = name() + ".pht";
+    SERIALIZE_SCALAR(phtFile);
+
+    const unsigned storageBits = storageBitsFor(phtCtrBits);
+    PackedSatCounterTable converted;
+    const PackedSatCounterTable *table = &packedCounters;
+    if (!packedPHT) {
+        converted = PackedSatCounterTable(predictorSize, storageBits);
+        for (unsigned idx = 0; idx < predictorSize; idx++) {
+            converted.write(idx, counterValue(idx));
+        }
+        table = &converted;
+    }
+
+    PHTFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, PHTFileMagic, sizeof(header.magic));
+    header.version = PHTFileVersion;
+    header.ctrBits = phtCtrBits;
+    header.storageBits = storageBits;
+    header.entries = predictorSize;
+    header.words = table->rawWords().size();
+
+    const std::string path = CheckpointIn::dir() + "/" + phtFile;
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(table->rawWords().data()),
+              header.words * sizeof(uint64_t));
+    fatal_if(!out, "Failed to write PHT checkpoint %s.\n", path);
+
+    // The PHT file has the tagged counters; the rest of the tagged PHT
+    // is small enough for the checkpoint itself.
+    if (taggedWays) {
+        arrayParamOut(cp, "taggedTags", taggedPHT.rawTags());
+        arrayParamOut(cp, "taggedUseful", taggedPHT.rawUseful());
+        arrayParamOut(cp, "bimodalCounters", taggedPHT.rawBimodal());
+    }
+
+    // Child sections go last; anything written after them would land in
+    // the last child's section.
+    for (unsigned tid = 0; tid < foldedHistories.size(); tid++) {
+        ScopedCheckpointSection sec(cp, csprintf("folded%d", tid));
+        const FoldedHistory &folded = foldedHistories[tid];
+        const unsigned position = folded.position();
+        const unsigned value = folded.value();
+        SERIALIZE_SCALAR(position);
+        SERIALIZE_SCALAR(value);
+        arrayParamOut(cp, "outcomes", folded.buffer());
+    }
+}
+
+void
+GSelectBP::unserialize(CheckpointIn &cp)
+{
+    unsigned savedPredictorSize, savedCtrBits, savedHistoryBits;
+    unsigned savedFoldedBits, savedIndexFunction;
+    paramIn(cp, "predictorSize", savedPredictorSize);
+    paramIn(cp, "phtCtrBits", savedCtrBits);
+    paramIn(cp, "globalHistoryBits", savedHistoryBits);
+    paramIn(cp, "foldedHistoryBits", savedFoldedBits);
+    paramIn(cp, "indexFunctionId", savedIndexFunction);
+    // Checkpoints from before the thread-hashed index used the plain one.
+    bool savedThreadHashedIndex = false;
+    optParamIn(cp, "threadHashedIndex", savedThreadHashedIndex, false);
+    unsigned savedTaggedWays = 0, savedTagBits = 0, savedBimodalSize = 0;
+    optParamIn(cp, "taggedWays", savedTaggedWays, false);
+    optParamIn(cp, "tagBits", savedTagBits, false);
+    optParamIn(cp, "bimodalSize", savedBimodalSize, false);
+    fatal_if(savedPredictorSize != predictorSize ||
+             savedCtrBits != phtCtrBits ||
+             savedHistoryBits != globalHistoryBits ||
+             savedFoldedBits != foldedHistoryBits ||
+             savedIndexFunction != (unsigned)indexFunction ||
+             savedThreadHashedIndex != threadHashedIndex ||
+             savedTaggedWays != taggedWays ||
+             savedTagBits != taggedPHT.tagWidth() ||
+             savedBimodalSize != taggedPHT.bimodalSize(),
+             "%s: checkpoint was taken with a different GSelectBP "
+             "configuration.\n", name());
+
+    std::vector<unsigned> histories;
+    arrayParamIn(cp, "globalHistoryReg", histories);
+    fatal_if(histories.size() != globalHistoryReg.size(),
+             "%s: checkpoint has %d thread histories, expected %d.\n",
+             name(), histories.size(), globalHistoryReg.size());
+    for (unsigned tid = 0; tid < histories.size(); tid++) {
+        globalHistoryReg[tid] = histories[tid];
+    }
+
+    if (taggedWays) {
+        std::vector<uint16_t> taggedTags, taggedUseful;
+        std::vector<uint8_t> bimodalCounters;
+        UNSERIALIZE_CONTAINER(taggedTags);
+        UNSERIALIZE_CONTAINER(taggedUseful);
+        UNSERIALIZE_CONTAINER(bimodalCounters);
+        fatal_if(!taggedPHT.loadRaw(taggedTags, taggedUseful,
+                                    bimodalCounters),
+                 "%s: tagged PHT size mismatch in checkpoint.\n", name());
+    }
+
+    for (unsigned tid = 0; tid < foldedHistories.size(); tid++) {
+        ScopedCheckpointSection sec(cp, csprintf("folded%d", tid));
+        unsigned position, value;
+        std::vector<uint8_t> outcomes;
+        UNSERIALIZE_SCALAR(position);
+        UNSERIALIZE_SCALAR(value);
+        arrayParamIn(cp, "outcomes", outcomes);
+        fatal_if(outcomes.size() != foldedHistories[tid].buffer().size(),
+                 "%s: folded history size mismatch in checkpoint.\n",
+                 name());
+        foldedHistories[tid].load(outcomes, position, value);
+    }
+
+    std::string phtFile;
+    UNSERIALIZE_SCALAR(phtFile);
+    const std::string path = cp.getCptDir() + "/" + phtFile;
+
+    const int fd = open(path.c_str(), O_RDONLY);
+    fatal_if(fd < 0, "Can't open PHT checkpoint %s.\n", path);
+    struct stat st;
+    fatal_if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(PHTFileHeader),
+             "PHT checkpoint %s is truncated.\n", path);
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    fatal_if(map == MAP_FAILED, "Can't map PHT checkpoint %s.\n", path);
+
+    const PHTFileHeader *header = static_cast<const PHTFileHeader *>(map);
+    const unsigned storageBits = storageBitsFor(phtCtrBits);
+    fatal_if(std::memcmp(header->magic, PHTFileMagic,
+                         sizeof(header->magic)) != 0 ||
+             header->version != PHTFileVersion,
+             "%s is not a GSelectBP PHT checkpoint.\n", path);
+    fatal_if(header->ctrBits != phtCtrBits ||
+             header->storageBits != storageBits ||
+             header->entries != predictorSize ||
+             header->words != divCeil(predictorSize, 64 / storageBits) ||
+             sizeof(PHTFileHeader) + header->words * sizeof(uint64_t) >
+             (uint64_t)st.st_size,
+             "PHT checkpoint %s does not match this predictor.\n", path);
+
+    // The counters are copied out of the mapping rather than used in
+    // place. A private mapping still reads through to the file for pages
+    // not yet written, so a later checkpoint to the same directory, which
+    // rewrites the file, would change or truncate the live PHT under the
+    // simulation. Only the packed layout matches the file anyway, and the
+    // copy is one pass over at most a few MB at restore time. A packed
+    // PHT takes the words with a single copy; the other layouts are
+    // decoded straight from the mapping.
+    const uint64_t *words = reinterpret_cast<const uint64_t *>(header + 1);
+    if (packedPHT) {
+        packedCounters.loadRawWords(words);
+    } else {
+        for (unsigned idx = 0; idx < predictorSize; idx++) {
+            setCounterValue(idx, PackedSatCounterTable::readRaw(
+                words, idx, storageBits));
+        }
+    }
+    munmap(map, st.st_size);
+}
@@ -1,11 +1,22 @@
 #ifndef __CPU_PRED_GSELECT_PRED_HH__
 #define __CPU_PRED_GSELECT_PRED_HH__
 
+#include <memory>
 #include <vector>
 
 #include "base/sat_counter.hh"
+#include "base/statistics.hh"
 #include "base/types.hh"
+#include "cpu/pred/bp_call_log.hh"
 #include "cpu/pred/bpred_unit.hh"
+#include "cpu/pred/branch_profiler.hh"
+#include "cpu/pred/folded_history.hh"
+#include "cpu/pred/gselect_kernel.hh"
+#include "cpu/pred/history_arena.hh"
+#include "cpu/pred/packed_counters.hh"
+#include "cpu/pred/per_thread.hh"
+#include "cpu/pred/tagged_pht.hh"
+#include "enums/GSelectIndexFunction.hh"
 #include "base/sat_counter.hh"
 #include "cpu/pred/bpred_unit.hh"
 #include "params/GSelectBP.hh"
@@ -21,25 +32,179 @@ class GSelectBP : public BPredUnit
         void btbUpdate(ThreadID tid, Addr branch_addr, void * &bp_history);
         void update(ThreadID tid, Addr branch_addr, bool taken, void *bp_history,
                     bool squashed, const StaticInstPtr & inst, Addr corrTarget);
+
+        /**
+         * Save the PHT to a compact binary file next to the checkpoint
+         * and the per-thread histories to the checkpoint itself.
+         */
+        void serialize(CheckpointOut &cp) const override;
+
+        /** Restore the state saved by serialize(), mapping the PHT file. */
+        void unserialize(CheckpointIn &cp) override;
+
+        /**
+         * Train the predictor on a committed branch without predicting
+         * it, for functional warming while fast-forwarding. The PHT and
+         * global history end up as the lookup()/update() sequence of a
+         * correctly resolved branch would leave them, but no BPHistory
+         * is allocated and nothing is profiled.
+         *
+         * @param conditional Unconditional branches only shift a taken
+         * outcome into the history.
+         */
+        void warm(ThreadID tid, Addr branch_addr, bool conditional,
+                  bool taken);
+
+        /** Start the call log, once any checkpoint has been restored. */
+        void startup() override;
+
+        /**
+         * Hash of everything that determines future predictions: the PHT
+         * counters and the per-thread histories. Two predictors with the
+         * same digest behave identically, whatever their PHT storage.
+         */
+        uint64_t stateDigest() const;
     private:
         void updateGlobalHistReg(ThreadID tid, bool taken);
 
         struct BPHistory {
+            /** History the prediction was made with; folded if
+             * foldedHistoryBits is set. */
             unsigned globalHistoryReg;
+            /** Folded history buffer position to roll back to. */
+            unsigned historyPtr;
+            /** Profiler handle of the branch. */
+            unsigned profileSlot;
+            /** Call log sequence number of the record. */
+            uint32_t callId;
             bool finalPred;
         };
 
+        /**
+         * Take a history record from the thread's arena, falling back to
+         * the heap only when the arena is full.
+         */
+        BPHistory *allocHistory(ThreadID tid);
+
+        /** Give back a record obtained from allocHistory(). */
+        void freeHistory(ThreadID tid, BPHistory *history);
+
+        /** Per-thread arenas for in-flight BPHistory records. */
+        PerThread<HistoryArena<BPHistory>> historyArenas;
+
         unsigned getGlobalIndex(ThreadID tid,Addr branchAddr,unsigned historyReg);
-        std::vector<unsigned> globalHistoryReg;
+
+        /** History value used for indexing, folded if enabled. */
+        unsigned currentHistory(ThreadID tid) const;
+
+        /** Checkpoint the thread's history into a BPHistory. */
+        void saveHistory(ThreadID tid, BPHistory *history) const;
+
+        /** Roll the thread's history back to a BPHistory checkpoint. */
+        void restoreHistory(ThreadID tid, const BPHistory *history);
+
+        /** Read the PHT counter at idx from whichever storage is in use. */
+        uint8_t counterValue(unsigned idx) const;
+
+        /** Overwrite the PHT counter at idx, e.g. from a checkpoint. */
+        void setCounterValue(unsigned idx, uint8_t val);
+
+        /** Train the PHT counter at idx towards the branch outcome. */
+        void trainCounter(unsigned idx, bool taken);
+
+        /**
+         * Train the tagged PHT on a resolved branch predicted with
+         * historyReg, allocating an entry if the bimodal table got it
+         * wrong.
+         */
+        void trainTagged(ThreadID tid, Addr branch_addr, unsigned historyReg,
+                         bool taken);
+
+        PerThread<unsigned> globalHistoryReg;
         unsigned globalHistoryBits;
         unsigned globalHistoryMask;
+
+        /**
+         * Width the history is folded to for indexing, or 0 to index with
+         * globalHistoryReg directly. Folding lifts the 32-bit limit on
+         * globalHistoryBits.
+         */
+        unsigned foldedHistoryBits;
+        PerThread<FoldedHistory> foldedHistories;
+        /** Mask applied to the (folded) history in the index. */
+        unsigned historyIndexMask;
         unsigned branchAddressBits;
         unsigned phtCtrBits;
         unsigned predictorSize;
         unsigned branchAddressMask;
+        unsigned indexMask;
+        unsigned indexBits;
+        const Enums::GSelectIndexFunction indexFunction;
+        /**
+         * Whether each thread's PHT index is XORed with a hash of its
+         * thread ID, so that threads running the same code use different
+         * counters. Thread 0 indexes as without it.
+         */
+        const bool threadHashedIndex;
+        /** Whether the PHT lives in packedCounters or finalCounters. */
+        const bool packedPHT;
         std::vector<SatCounter8> finalCounters;
+        PackedSatCounterTable packedCounters;
+
+        /**
+         * Ways of the tagged PHT, or 0 for the direct-mapped one. When
+         * set, taggedPHT holds the PHT and the gselect index picks its
+         * set.
+         */
+        const unsigned taggedWays;
+        TaggedPHT taggedPHT;
+
+        /**
+         * Specialised core for this geometry. When set it owns the PHT
+         * and finalCounters is left empty.
+         */
+        std::unique_ptr<GSelectKernelBase> kernel;
 
         unsigned predictionThreshold;
+
+        /** Per-PC misprediction profile, if enabled. */
+        std::unique_ptr<BranchProfiler> profiler;
+        unsigned profileTopN;
+        bool profileJSON;
+
+        /** Write the profile's worst offenders to the output directory. */
+        void dumpProfile();
+
+        /** Whether to record every call into <name>.calllog. */
+        const bool recordCalls;
+        const unsigned callLogBufferSize;
+        /** Call recorder, from startup() until the simulation exits. */
+        std::unique_ptr<BPCallLog> callLog;
+
+        struct GSelectBPStats : public Stats::Group
+        {
+            GSelectBPStats(GSelectBP *parent);
+
+            /**
+             * The history stats are counted by each thread's arena, on
+             * lines only that thread writes, and summed here.
+             */
+            void preDumpStats() override;
+            void resetStats() override;
+
+            GSelectBP &predictor;
+
+            /** History records requested from the arenas. */
+            Stats::Scalar historyAllocs;
+            /** History records that did not fit and went to the heap. */
+            Stats::Scalar historyOverflows;
+            /** Highest arena occupancy seen on any thread. */
+            Stats::Scalar historyPeakOccupancy;
+            /** Lookups predicted by a tagged PHT entry. */
+            Stats::Scalar taggedHits;
+            /** Tagged PHT entries allocated. */
+            Stats::Scalar taggedAllocations;
+        } gselectStats;
 };
 
 #endif // __CPU_PRED_GSELECT_PRED_HH__
@@ -0,0 +1,118 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Instantiation of the specialised gselect cores.
+ */
+
+#include "cpu/pred/gselect_kernel.hh"
+
+namespace
+{
+
+const unsigned MinKernelHistoryBits = 8;
+const unsigned MaxKernelHistoryBits = 16;
+
+/**
+ * Walk the history lengths [HistoryBits, EndBits) looking for the one
+ * asked for.
+ */
+template <unsigned LogSize, unsigned CtrBits, unsigned HistoryBits,
+          unsigned EndBits>
+struct KernelFactory
+{
+    static std::unique_ptr<GSelectKernelBase>
+    make(unsigned history_bits, unsigned inst_shift_amt)
+    {
+        if (history_bits == HistoryBits) {
+            return std::unique_ptr<GSelectKernelBase>(
+                new GSelectKernel<LogSize, HistoryBits, CtrBits>(
+                    inst_shift_amt));
+        }
+        return KernelFactory<LogSize, CtrBits, HistoryBits + 1, EndBits>::
+            make(history_bits, inst_shift_amt);
+    }
+};
+
+template <unsigned LogSize, unsigned CtrBits, unsigned EndBits>
+struct KernelFactory<LogSize, CtrBits, EndBits, EndBits>
+{
+    static std::unique_ptr<GSelectKernelBase>
+    make(unsigned history_bits, unsigned inst_shift_amt)
+    {
+        return nullptr;
+    }
+};
+
+template <unsigned LogSize, unsigned CtrBits>
+std::unique_ptr<GSelectKernelBase>
+makeForSize(unsigned history_bits, unsigned inst_shift_amt)
+{
+    const unsigned end_bits = (LogSize < MaxKernelHistoryBits ?
+                               LogSize : MaxKernelHistoryBits) + 1;
+    return KernelFactory<LogSize, CtrBits, MinKernelHistoryBits,
+                         end_bits>::make(history_bits, inst_shift_amt);
+}
+
+template <unsigned CtrBits>
+std::unique_ptr<GSelectKernelBase>
+makeForCtrBits(unsigned predictor_size, unsigned history_bits,
+               unsigned inst_shift_amt)
+{
+    switch (predictor_size) {
+      case 1 << 10:
+        return makeForSize<10, CtrBits>(history_bits, inst_shift_amt);
+      case 1 << 12:
+        return makeForSize<12, CtrBits>(history_bits, inst_shift_amt);
+      case 1 << 14:
+        return makeForSize<14, CtrBits>(history_bits, inst_shift_amt);
+      case 1 << 16:
+        return makeForSize<16, CtrBits>(history_bits, inst_shift_amt);
+      default:
+        return nullptr;
+    }
+}
+
+} // anonymous namespace
+
+std::unique_ptr<GSelectKernelBase>
+makeGSelectKernel(unsigned predictor_size, unsigned history_bits,
+                  unsigned ctr_bits, unsigned inst_shift_amt)
+{
+    switch (ctr_bits) {
+      case 2:
+        return makeForCtrBits<2>(predictor_size, history_bits,
+                                 inst_shift_amt);
+      case 3:
+        return makeForCtrBits<3>(predictor_size, history_bits,
+                                 inst_shift_amt);
+      default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * GSelect prediction cores specialised at compile time for common
+ * predictor geometries.
+ */
+
+#ifndef __CPU_PRED_GSELECT_KERNEL_HH__
+#define __CPU_PRED_GSELECT_KERNEL_HH__
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+#include "base/types.hh"
+
+/**
+ * The PHT of a gselect predictor together with its index function. The
+ * caller keeps the global history and hands in the (masked or not)
+ * history register the prediction was made with.
+ */
+class GSelectKernelBase
+{
+  public:
+    virtual ~GSelectKernelBase() = default;
+
+    /** Predict the direction of the branch at branch_addr. */
+    virtual bool predict(unsigned history, Addr branch_addr) const = 0;
+
+    /** Train the counter used to predict the branch at branch_addr. */
+    virtual void train(unsigned history, Addr branch_addr, bool taken) = 0;
+
+    /** Raw counter access, e.g. for checkpointing. */
+    virtual uint8_t read(unsigned idx) const = 0;
+    virtual void write(unsigned idx, uint8_t val) = 0;
+};
+
+/**
+ * A gselect core whose table size, history length and counter width are
+ * template parameters, so the index masks and shifts, the prediction
+ * threshold and the saturation bounds all fold to constants. Counters
+ * are plain bytes holding the same values SatCounter8 would.
+ *
+ * @tparam LogSize log2 of the number of PHT entries.
+ * @tparam HistoryBits Global history bits used in the index.
+ * @tparam CtrBits Counter width in bits.
+ */
+template <unsigned LogSize, unsigned HistoryBits, unsigned CtrBits>
+class GSelectKernel : public GSelectKernelBase
+{
+  private:
+    static_assert(HistoryBits <= LogSize, "History wider than the index");
+    static_assert(CtrBits >= 1 && CtrBits <= 8, "Unsupported counter width");
+
+    static constexpr unsigned Size = 1u << LogSize;
+    static constexpr unsigned BranchAddressBits = LogSize - HistoryBits;
+    static constexpr unsigned HistoryMask = (1u << HistoryBits) - 1;
+    static constexpr Addr BranchAddressMask =
+        (Addr(1) << BranchAddressBits) - 1;
+    static constexpr uint8_t Threshold = (1u << (CtrBits - 1)) - 1;
+    static constexpr uint8_t CtrMax = (1u << CtrBits) - 1;
+
+    const unsigned instShiftAmt;
+
+    std::array<uint8_t, Size> counters;
+
+    unsigned
+    index(unsigned history, Addr branch_addr) const
+    {
+        return ((history & HistoryMask) << BranchAddressBits) |
+            ((branch_addr >> instShiftAmt) & BranchAddressMask);
+    }
+
+  public:
+    explicit GSelectKernel(unsigned inst_shift_amt)
+        : instShiftAmt(inst_shift_amt)
+    {
+        counters.fill(0);
+    }
+
+    bool
+    predict(unsigned history, Addr branch_addr) const override
+    {
+        return counters[index(history, branch_addr)] > Threshold;
+    }
+
+    void
+    train(unsigned history, Addr branch_addr, bool taken) override
+    {
+        uint8_t &ctr = counters[index(history, branch_addr)];
+        ctr += taken & (ctr != CtrMax);
+        ctr -= !taken & (ctr != 0);
+    }
+
+    uint8_t read(unsigned idx) const override { return counters[idx]; }
+
+    void write(unsigned idx, uint8_t val) override { counters[idx] = val; }
+};
+
+/**
+ * Build the specialised core for a geometry, if there is one. Cores
+ * exist for 1K, 4K, 16K and 64K entries with 2- or 3-bit counters and 8
+ * to 16 history bits (up to the index width).
+ *
+ * @return The core, or nullptr if the geometry is not specialised.
+ */
+std::unique_ptr<GSelectKernelBase> makeGSelectKernel(
+    unsigned predictor_size, unsigned history_bits, unsigned ctr_bits,
+    unsigned inst_shift_amt);
+
+#endif // __CPU_PRED_GSELECT_KERNEL_HH__
@@ -0,0 +1,185 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A fixed-capacity ring arena for speculative branch predictor history
+ * records.
+ */
+
+#ifndef __CPU_PRED_HISTORY_ARENA_HH__
+#define __CPU_PRED_HISTORY_ARENA_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "base/intmath.hh"
+#include "cpu/pred/per_thread.hh"
+
+/**
+ * Ring arena handing out history records in program order. Branches are
+ * predicted in order, committed from the oldest end and squashed from
+ * the youngest end, so a slot is normally released at the head or the
+ * tail of the ring. Out of order releases just leave a hole that is
+ * reclaimed once everything in front of it has been released.
+ *
+ * When the ring is full allocate() returns nullptr and the caller falls
+ * back to the heap; owns() tells the two kinds of records apart.
+ *
+ * The slots and their live bytes share one block of whole host cache
+ * lines, so arenas of different threads never share a line. The arena
+ * also counts its allocations itself, keeping the per-record bookkeeping
+ * on lines only its thread writes.
+ */
+template <class Record>
+class HistoryArena
+{
+  private:
+    static_assert(alignof(Record) <= HostLineSize,
+                  "HistoryArena records must not need more than line "
+                  "alignment");
+
+    const size_t numSlots;
+
+    /** Bytes of the slots, padded so that live starts a line. */
+    const size_t slotBytes;
+
+    Record *const slots;
+
+    /** One byte per slot marking whether it is still in use. */
+    uint8_t *const live;
+
+    const size_t slotMask;
+
+    /** Monotonic positions of the oldest and next free slot. */
+    size_t head;
+    size_t tail;
+
+    size_t peak;
+    uint64_t allocs;
+    uint64_t overflows;
+
+  public:
+    /**
+     * @param capacity Number of slots, rounded up to a power of 2.
+     */
+    explicit HistoryArena(size_t capacity)
+        : numSlots(size_t(1) << ceilLog2(capacity)),
+          slotBytes(roundUpToLines(numSlots * sizeof(Record))),
+          slots(static_cast<Record *>(
+                allocLines(roundUpToLines(slotBytes + numSlots)))),
+          live(reinterpret_cast<uint8_t *>(slots) + slotBytes),
+          slotMask(numSlots - 1),
+          head(0), tail(0), peak(0), allocs(0), overflows(0)
+    {
+        for (size_t i = 0; i < numSlots; i++) {
+            new (&slots[i]) Record();
+        }
+        std::memset(live, 0, numSlots);
+    }
+
+    HistoryArena(const HistoryArena &) = delete;
+    HistoryArena &operator=(const HistoryArena &) = delete;
+
+    ~HistoryArena()
+    {
+        for (size_t i = 0; i < numSlots; i++) {
+            slots[i].~Record();
+        }
+        std::free(slots);
+    }
+
+    /**
+     * Take the next slot in program order.
+     *
+     * @return The slot, or nullptr if the ring is full.
+     */
+    Record *
+    allocate()
+    {
+        allocs++;
+        if (tail - head == numSlots) {
+            overflows++;
+            return nullptr;
+        }
+        const size_t slot = tail++ & slotMask;
+        live[slot] = 1;
+        if (tail - head > peak) {
+            peak = tail - head;
+        }
+        return &slots[slot];
+    }
+
+    /** Return a slot obtained from allocate(). */
+    void
+    release(Record *record)
+    {
+        live[record - slots] = 0;
+        while (tail != head && !live[(tail - 1) & slotMask]) {
+            tail--;
+        }
+        while (head != tail && !live[head & slotMask]) {
+            head++;
+        }
+    }
+
+    /** Whether a record lives in this arena rather than on the heap. */
+    bool
+    owns(const Record *record) const
+    {
+        return record >= slots && record < slots + numSlots;
+    }
+
+    /** Slots between the oldest and youngest live record. */
+    size_t occupancy() const { return tail - head; }
+
+    /** Highest occupancy seen since construction or resetCounts(). */
+    size_t peakOccupancy() const { return peak; }
+
+    /** Calls to allocate(), including those that overflowed. */
+    uint64_t allocations() const { return allocs; }
+
+    /** Calls to allocate() that found the ring full. */
+    uint64_t overflowCount() const { return overflows; }
+
+    /** Restart the counts, as on a stats reset. */
+    void
+    resetCounts()
+    {
+        peak = occupancy();
+        allocs = 0;
+        overflows = 0;
+    }
+
+    size_t capacity() const { return numSlots; }
+};
+
+#endif // __CPU_PRED_HISTORY_ARENA_HH__
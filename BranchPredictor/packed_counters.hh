@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A table of saturating counters packed several to a 64-bit word.
+ */
+
+#ifndef __CPU_PRED_PACKED_COUNTERS_HH__
+#define __CPU_PRED_PACKED_COUNTERS_HH__
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+/**
+ * Unsigned saturating counters of 1, 2, 4 or 8 bits stored back to back
+ * in 64-bit words, e.g. 32 2-bit counters per word. Counters start at
+ * zero and behave exactly like SatCounter8 of the same width, but the
+ * table takes a quarter of the host memory for 2-bit counters and the
+ * saturating update is branch free.
+ */
+class PackedSatCounterTable
+{
+  private:
+    std::vector<uint64_t> words;
+
+    unsigned ctrBits;
+    /** log2 of counters per word. */
+    unsigned ctrsPerWordShift;
+    uint64_t ctrMask;
+
+    unsigned shiftOf(unsigned idx) const
+    {
+        return (idx & ((1u << ctrsPerWordShift) - 1)) * ctrBits;
+    }
+
+  public:
+    PackedSatCounterTable() : ctrBits(0), ctrsPerWordShift(0), ctrMask(0) {}
+
+    /**
+     * @param entries Number of counters.
+     * @param bits Counter width; must be 1, 2, 4 or 8.
+     */
+    PackedSatCounterTable(unsigned entries, unsigned bits)
+        : ctrBits(bits)
+    {
+        fatal_if(bits == 0 || bits > 8 || !isPowerOf2(bits),
+                 "Packed counters must be 1, 2, 4 or 8 bits wide.\n");
+        ctrsPerWordShift = floorLog2(64 / bits);
+        ctrMask = (1ULL << bits) - 1;
+        words.assign(divCeil(entries, 1u << ctrsPerWordShift), 0);
+    }
+
+    uint8_t
+    read(unsigned idx) const
+    {
+        return (words[idx >> ctrsPerWordShift] >> shiftOf(idx)) & ctrMask;
+    }
+
+    void
+    write(unsigned idx, uint8_t val)
+    {
+        uint64_t &word = words[idx >> ctrsPerWordShift];
+        const unsigned shift = shiftOf(idx);
+        word = (word & ~(ctrMask << shift)) | ((val & ctrMask) << shift);
+    }
+
+    /**
+     * Count up if taken, down otherwise, saturating at both ends.
+     */
+    void
+    update(unsigned idx, bool taken)
+    {
+        uint64_t &word = words[idx >> ctrsPerWordShift];
+        const unsigned shift = shiftOf(idx);
+        const uint64_t ctr = (word >> shift) & ctrMask;
+        const uint64_t inc = taken & (ctr != ctrMask);
+        const uint64_t dec = !taken & (ctr != 0);
+        word += (inc - dec) << shift;
+    }
+
+    /** Host memory used by the counters, in bytes. */
+    size_t bytes() const { return words.size() * sizeof(uint64_t); }
+
+    unsigned bitsPerCounter() const { return ctrBits; }
+
+    /** The packed words, e.g. for writing them to a checkpoint. */
+    const std::vector<uint64_t> &rawWords() const { return words; }
+
+    /** read() of counter idx in words saved from a table of bits-wide
+     * counters, without loading them into one. */
+    static uint8_t
+    readRaw(const uint64_t *src, unsigned idx, unsigned bits)
+    {
+        const unsigned per_word_shift = floorLog2(64 / bits);
+        const unsigned shift =
+            (idx & ((1u << per_word_shift) - 1)) * bits;
+        return (src[idx >> per_word_shift] >> shift) & ((1ULL << bits) - 1);
+    }
+
+    /** Replace the packed words with ones saved from rawWords(). */
+    void
+    loadRawWords(const uint64_t *src)
+    {
+        std::copy(src, src + words.size(), words.begin());
+    }
+};
+
+#endif // __CPU_PRED_PACKED_COUNTERS_HH__
@@ -0,0 +1,144 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Per-thread predictor state kept on separate host cache lines.
+ */
+
+#ifndef __CPU_PRED_PER_THREAD_HH__
+#define __CPU_PRED_PER_THREAD_HH__
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/** Host cache line size assumed for the padding. */
+constexpr size_t HostLineSize = 64;
+
+/** bytes rounded up to a whole number of host cache lines. */
+constexpr size_t
+roundUpToLines(size_t bytes)
+{
+    return (bytes + HostLineSize - 1) / HostLineSize * HostLineSize;
+}
+
+/**
+ * Memory starting a host cache line, to be released with std::free().
+ * bytes should be a multiple of HostLineSize, so the block also ends on
+ * a line of its own.
+ */
+inline void *
+allocLines(size_t bytes)
+{
+    void *mem;
+    if (posix_memalign(&mem, HostLineSize, bytes) != 0) {
+        throw std::bad_alloc();
+    }
+    return mem;
+}
+
+/**
+ * One T per hardware thread, each starting a host cache line of its own
+ * and padded to a whole number of lines. A plain vector packs small
+ * per-thread values into the same line, so host threads simulating
+ * different SMT threads would keep stealing it from each other.
+ */
+template <class T>
+class PerThread
+{
+  public:
+    static constexpr size_t LineSize = HostLineSize;
+
+    static_assert(alignof(T) <= LineSize,
+                  "PerThread elements must not need more than line "
+                  "alignment");
+
+    PerThread() : storage(nullptr), count(0) {}
+
+    /** Construct n elements as T(args...). */
+    template <class... Args>
+    explicit PerThread(size_t n, const Args &... args)
+        : PerThread()
+    {
+        init(n, args...);
+    }
+
+    PerThread(const PerThread &) = delete;
+    PerThread &operator=(const PerThread &) = delete;
+
+    ~PerThread() { clear(); }
+
+    /** Replace the contents with n elements constructed as T(args...). */
+    template <class... Args>
+    void
+    init(size_t n, const Args &... args)
+    {
+        clear();
+        if (n == 0) {
+            return;
+        }
+        storage = static_cast<char *>(allocLines(n * Stride));
+        for (; count < n; count++) {
+            new (storage + count * Stride) T(args...);
+        }
+    }
+
+    T &
+    operator[](size_t tid)
+    {
+        return *reinterpret_cast<T *>(storage + tid * Stride);
+    }
+
+    const T &
+    operator[](size_t tid) const
+    {
+        return *reinterpret_cast<const T *>(storage + tid * Stride);
+    }
+
+    size_t size() const { return count; }
+
+  private:
+    /** Bytes from one element to the next, a multiple of LineSize. */
+    static constexpr size_t Stride = roundUpToLines(sizeof(T));
+
+    void
+    clear()
+    {
+        while (count > 0) {
+            (*this)[--count].~T();
+        }
+        std::free(storage);
+        storage = nullptr;
+    }
+
+    char *storage;
+    size_t count;
+};
+
+#endif // __CPU_PRED_PER_THREAD_HH__
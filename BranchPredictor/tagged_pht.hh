@@ -0,0 +1,296 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A tagged set-associative pattern history table backed by a bimodal
+ * table.
+ */
+
+#ifndef __CPU_PRED_TAGGED_PHT_HH__
+#define __CPU_PRED_TAGGED_PHT_HH__
+
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "base/bitfield.hh"
+#include "base/intmath.hh"
+#include "base/logging.hh"
+#include "base/types.hh"
+
+/**
+ * Counters indexed by set and partial tag, so that branches whose index
+ * collides only share a counter if their tags collide too. A lookup
+ * that misses in the tagged table is predicted by a PC-indexed bimodal
+ * table instead.
+ *
+ * Each tagged entry has a useful bit, set when the entry predicted
+ * correctly where the bimodal table would not have, and cleared when it
+ * was wrong where the bimodal table was right. A branch the bimodal
+ * table mispredicts gets an entry in its set: an invalid way if there
+ * is one, else the lowest way that is not useful. If every way is
+ * useful, the set's useful bits are cleared instead, so a new branch
+ * gets in on its next misprediction.
+ *
+ * The tags of a set are 16-bit lanes, padded to a multiple of 8, with
+ * the top bit marking a valid entry, and are compared with the lookup
+ * tag all at once with SSE2 or AVX2 where available.
+ */
+class TaggedPHT
+{
+  public:
+    /** find() result when no way matches. */
+    static const int Miss = -1;
+
+    enum : unsigned
+    {
+        /** Widest supported tag; the bit above it is the valid bit. */
+        MaxTagBits = 15,
+        MaxWays = 16
+    };
+
+    TaggedPHT()
+        : ways(0), setBits(0), tagBits(0), stride(0), ctrMax(0),
+          threshold(0), bimodalMask(0)
+    {}
+
+    /**
+     * @param entries Tagged entries in total, a power of 2.
+     * @param num_ways Ways per set, a power of 2 up to MaxWays.
+     * @param tag_bits Partial tag width, up to MaxTagBits.
+     * @param ctr_bits Counter width of both tables.
+     * @param bimodal_entries Bimodal table size, a power of 2.
+     */
+    TaggedPHT(unsigned entries, unsigned num_ways, unsigned tag_bits,
+              unsigned ctr_bits, unsigned bimodal_entries)
+        : ways(num_ways), tagBits(tag_bits),
+          stride(num_ways <= 8 ? 8u : unsigned(MaxWays)),
+          ctrMax((1u << ctr_bits) - 1),
+          threshold((1u << (ctr_bits - 1)) - 1),
+          bimodalMask(bimodal_entries - 1)
+    {
+        fatal_if(ways == 0 || ways > MaxWays || !isPowerOf2(ways),
+                 "Tagged PHT ways must be a power of 2 up to %d.\n",
+                 MaxWays);
+        fatal_if(!isPowerOf2(entries) || entries < ways,
+                 "Tagged PHT size must be a power of 2 of at least one "
+                 "set.\n");
+        fatal_if(tagBits == 0 || tagBits > MaxTagBits,
+                 "Tagged PHT tags must be 1 to %d bits wide.\n",
+                 MaxTagBits);
+        fatal_if(!isPowerOf2(bimodal_entries),
+                 "The bimodal table size must be a power of 2.\n");
+        const unsigned sets = entries / ways;
+        setBits = floorLog2(sets);
+        tags.assign(sets * stride, 0);
+        counters.assign(entries, 0);
+        useful.assign(sets, 0);
+        bimodal.assign(bimodal_entries, 0);
+    }
+
+    /**
+     * Set of a predictor index, folding the index bits above the set
+     * bits back in so that none of them is lost.
+     */
+    unsigned
+    setOf(unsigned idx) const
+    {
+        return (idx ^ (idx >> setBits)) & mask(setBits);
+    }
+
+    /** Partial tag, with the valid bit, of a PC and history. */
+    uint16_t
+    tagOf(Addr pc, unsigned history) const
+    {
+        const uint64_t key = (uint64_t(history) << 32) ^ pc;
+        return (key * ULL(0xd6e8feb86659fd93)) >> (64 - tagBits) |
+            (1u << MaxTagBits);
+    }
+
+    unsigned bimodalOf(Addr pc) const { return pc & bimodalMask; }
+
+    /** Way of set holding tag, or Miss. */
+    int
+    find(unsigned set, uint16_t tag) const
+    {
+        const uint16_t *set_tags = &tags[set * stride];
+        uint32_t match = 0;
+#if defined(__AVX2__)
+        if (stride == 16) {
+            const __m256i lanes = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(set_tags));
+            match = _mm256_movemask_epi8(
+                _mm256_cmpeq_epi16(lanes, _mm256_set1_epi16(tag)));
+        } else
+#endif
+        {
+#if defined(__SSE2__)
+            const __m128i key = _mm_set1_epi16(tag);
+            for (unsigned lane = 0; lane < stride; lane += 8) {
+                const __m128i lanes = _mm_loadu_si128(
+                    reinterpret_cast<const __m128i *>(set_tags + lane));
+                match |= uint32_t(_mm_movemask_epi8(
+                    _mm_cmpeq_epi16(lanes, key))) << (2 * lane);
+            }
+#else
+            for (unsigned way = 0; way < ways; way++) {
+                match |= uint32_t(set_tags[way] == tag) << (2 * way);
+            }
+#endif
+        }
+        // Two mask bits per 16-bit lane; drop the padding lanes.
+        match &= mask(2 * ways);
+        return match ? findLsbSet(match) / 2 : Miss;
+    }
+
+    /**
+     * Counter that makes the prediction: the tagged entry at way of set,
+     * or the bimodal one if way is Miss.
+     */
+    uint8_t
+    providerCounter(unsigned set, int way, unsigned bimodal_idx) const
+    {
+        return way == Miss ? bimodal[bimodal_idx] :
+            counters[set * ways + way];
+    }
+
+    /**
+     * Train the table on a resolved branch.
+     *
+     * @return Whether a tagged entry was allocated for it.
+     */
+    bool
+    update(unsigned set, uint16_t tag, unsigned bimodal_idx, bool taken)
+    {
+        uint8_t &base = bimodal[bimodal_idx];
+        const bool base_taken = base > threshold;
+        const int way = find(set, tag);
+        if (way != Miss) {
+            uint8_t &ctr = counters[set * ways + way];
+            const bool tagged_taken = ctr > threshold;
+            if (tagged_taken != base_taken) {
+                if (tagged_taken == taken) {
+                    useful[set] |= 1u << way;
+                } else {
+                    useful[set] &= ~(1u << way);
+                }
+            }
+            train(ctr, taken);
+            return false;
+        }
+
+        train(base, taken);
+        if (base_taken == taken) {
+            return false;
+        }
+        int victim = find(set, 0);
+        if (victim == Miss) {
+            const unsigned candidates = ~useful[set] & mask(ways);
+            if (!candidates) {
+                useful[set] = 0;
+                return false;
+            }
+            victim = findLsbSet(candidates);
+        }
+        tags[set * stride + victim] = tag;
+        counters[set * ways + victim] = taken ? threshold + 1 : threshold;
+        useful[set] &= ~(1u << victim);
+        return true;
+    }
+
+    unsigned size() const { return counters.size(); }
+    unsigned tagWidth() const { return tagBits; }
+    unsigned bimodalSize() const { return bimodal.size(); }
+
+    /** Tagged counter idx, in set-major order. */
+    uint8_t counter(unsigned idx) const { return counters[idx]; }
+    void setCounter(unsigned idx, uint8_t val) { counters[idx] = val; }
+
+    /**
+     * State besides the tagged counters, e.g. for a checkpoint: the tags
+     * of every set including padding, the per-set useful bits and the
+     * bimodal counters.
+     */
+    const std::vector<uint16_t> &rawTags() const { return tags; }
+    const std::vector<uint16_t> &rawUseful() const { return useful; }
+    const std::vector<uint8_t> &rawBimodal() const { return bimodal; }
+
+    /**
+     * Replace the state saved from the raw accessors.
+     * @return False if the sizes do not match this table.
+     */
+    bool
+    loadRaw(const std::vector<uint16_t> &saved_tags,
+            const std::vector<uint16_t> &saved_useful,
+            const std::vector<uint8_t> &saved_bimodal)
+    {
+        if (saved_tags.size() != tags.size() ||
+                saved_useful.size() != useful.size() ||
+                saved_bimodal.size() != bimodal.size()) {
+            return false;
+        }
+        tags = saved_tags;
+        useful = saved_useful;
+        bimodal = saved_bimodal;
+        return true;
+    }
+
+  private:
+    void
+    train(uint8_t &ctr, bool taken)
+    {
+        if (taken) {
+            ctr += ctr < ctrMax;
+        } else {
+            ctr -= ctr > 0;
+        }
+    }
+
+    unsigned ways;
+    unsigned setBits;
+    unsigned tagBits;
+    /** Tag lanes per set, ways rounded up to a whole vector. */
+    unsigned stride;
+    uint8_t ctrMax;
+    uint8_t threshold;
+    unsigned bimodalMask;
+
+    std::vector<uint16_t> tags;
+    std::vector<uint8_t> counters;
+    std::vector<uint16_t> useful;
+    std::vector<uint8_t> bimodal;
+};
+
+#endif // __CPU_PRED_TAGGED_PHT_HH__
@@ -0,0 +1,59 @@
+# Copyright (c) 2022 Ashish Kumar Rambhatla
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Declaration of LRUIPVRP. It belongs in gem5's
+# src/mem/cache/replacement_policies/ReplacementPolicies.py, next to the
+# other replacement policies and after BaseReplacementPolicy.
+
+from m5.params import *
+from m5.proxy import *
+
+class LRUIPVRP(BaseReplacementPolicy):
+    type = 'LRUIPVRP'
+    cxx_class = 'ReplacementPolicy::LRUIPVRP'
+    cxx_header = "mem/cache/replacement_policies/lru_ipv.hh"
+
+    numWays = Param.Unsigned(Parent.assoc,
+        "Associativity, a power of 2 between 2 and 64")
+    ipv = VectorParam.Unsigned([],
+        "Insertion/promotion vector: the stack position a hit moves a "
+        "block to, for each of the numWays positions, followed by the "
+        "position new blocks are inserted at. Empty for the 16-way vector "
+        "from the IPV paper, rescaled to numWays")
+    duelingIPVs = VectorParam.Unsigned([],
+        "Further IPVs, numWays + 1 entries each, to set-duel against ipv. "
+        "Leader sets run one IPV each and the remaining sets follow the "
+        "IPV whose leaders miss least")
+    duelingConstituency = Param.Unsigned(64,
+        "Sets per constituency when dueling; the first set of each "
+        "constituency leads for ipv, the next ones for each duelingIPVs "
+        "entry")
+    duelingCounterBits = Param.Unsigned(10,
+        "Width of the per-IPV leader miss counters; all are halved when "
+        "one saturates")
+    compactRecency = Param.Bool(False,
+        "Pack each set's recency state into 4 bits per way (at most 16 "
+        "ways) instead of a byte per way plus an LRU mask")
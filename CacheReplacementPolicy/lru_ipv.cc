@@ -33,52 +33,180 @@
 
 #include "mem/cache/replacement_policies/lru_ipv.hh"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <numeric>
 
+#include "base/bitfield.hh"
 #include "base/intmath.hh"
 #include "base/logging.hh"
+#include "base/output.hh"
 #include "base/trace.hh"
 #include "debug/LruIpv.hh"
-
-#define INVALID_RECENCY_VALUE 16
+#include "mem/cache/replacement_policies/lru_ipv_kernels.hh"
 
 
 namespace ReplacementPolicy {
 
 /* Constructor for the Replacement data struct. */
-LRUIPVRP::LRUIPVReplData::LRUIPVReplData(const uint64_t set_id, const uint64_t index, std::shared_ptr<RecencyStack> stack)
-  : set_id(set_id), index(index), stack(stack) {}
+LRUIPVRP::LRUIPVReplData::LRUIPVReplData(const uint32_t set_id, const uint32_t index)
+  : set_id(set_id), index(index) {}
 
 /* Constructor for the Replacement policy class. */
 LRUIPVRP::LRUIPVRP(const Params &p) 
     :   Base(p), 
         numWays(p.numWays),
+        setStride(uint64_t(1) << ceilLog2(p.numWays)),
         blockInstanceCounter(0),
-        tempStack(nullptr)
+        compact(p.compactRecency),
+        recencyCapacity(0),
+        numIPVs(1 + p.duelingIPVs.size() / (p.numWays + 1)),
+        constituencyMask(numIPVs > 1 ? p.duelingConstituency - 1 : 0),
+        leaderMisses(numIPVs, SatCounter16(p.duelingCounterBits)),
+        followerIPV(0),
+        traceStream(nullptr),
+        stats(*this)
 {
-    DPRINTF(LruIpv,
-            "Number of ways must be non-zero and a power of 2. It is %d\n", !isPowerOf2(numWays));
-    promotionVector = {0,0,1,0,3,0,1,2,1,0,5,1,0,0,1,11,13}; // copy the promo vector from paper
+    fatal_if(numWays < 2 || numWays > 64 || !isPowerOf2(numWays),
+             "%s: LRU-IPV needs a power of 2 between 2 and 64 ways, not %d.\n",
+             name(), numWays);
+    fatal_if(compact && numWays > 16,
+             "%s: compactRecency packs 4 bits per way and needs at most 16 "
+             "ways, not %d.\n", name(), numWays);
+
+    addIPV(p.ipv.empty() ? lruIpvDefaultIPV(numWays) : p.ipv);
+
+    fatal_if(p.duelingIPVs.size() % (numWays + 1) != 0,
+             "%s: duelingIPVs must hold whole IPVs of %d entries.\n",
+             name(), numWays + 1);
+    for (auto it = p.duelingIPVs.begin(); it != p.duelingIPVs.end();
+         it += numWays + 1) {
+        addIPV(std::vector<unsigned>(it, it + numWays + 1));
+    }
+
+    if (numIPVs > 1) {
+        fatal_if(!isPowerOf2(p.duelingConstituency) ||
+                 p.duelingConstituency <= numIPVs,
+                 "%s: duelingConstituency must be a power of 2 larger than "
+                 "the number of IPVs (%d).\n", name(), numIPVs);
+    }
+}
+
+LRUIPVRP::LRUIPVRPStats::LRUIPVRPStats(LRUIPVRP &_policy)
+    : Stats::Group(&_policy),
+      policy(_policy),
+      ADD_STAT(hitPosition,
+               "Number of hits by the recency position of the block"),
+      ADD_STAT(fills, "Number of blocks inserted"),
+      ADD_STAT(deadOnArrival,
+               "Number of blocks evicted without a hit since insertion"),
+      ADD_STAT(evictionAge,
+               "Accesses to the set between a block's insertion and eviction"),
+      ADD_STAT(setMisses, "Number of misses (insertions) per set")
+{
+}
+
+void
+LRUIPVRP::LRUIPVRPStats::regStats()
+{
+    Stats::Group::regStats();
+
+    hitPosition.init(policy.numWays);
+    evictionAge.init(16);
+    // The tags instantiate every block before stats are registered.
+    setMisses.init(policy.setUsage.size()).flags(Stats::nozero);
+}
+
+void
+LRUIPVRP::addIPV(const std::vector<unsigned> &ipv)
+{
+    fatal_if(ipv.size() != numWays + 1,
+             "%s: an IPV needs %d entries for %d ways (one promotion target "
+             "per stack position, then the insertion position), not %d.\n",
+             name(), numWays + 1, numWays, ipv.size());
+    for (unsigned pos = 0; pos <= numWays; pos++) {
+        fatal_if(ipv[pos] >= numWays,
+                 "%s: IPV %d entry %d (%d) is not a stack position.\n",
+                 name(), promotionTables.size(), pos, ipv[pos]);
+    }
+
+    // Fold the clamp of invalidated blocks into the promotion lookup.
+    std::vector<uint8_t> table(numWays + 1);
+    for (unsigned pos = 0; pos <= numWays; pos++) {
+        table[pos] = ipv[std::min<unsigned>(pos, numWays - 1)];
+    }
+    promotionTables.push_back(table);
+    insertionPositions.push_back(ipv[numWays]);
+}
+
+void
+LRUIPVRP::recordFill(uint64_t set_id) const
+{
+    const uint64_t offset = set_id & constituencyMask;
+    if (numIPVs == 1 || offset >= numIPVs) {
+        return;
+    }
+
+    SatCounter16 &misses = leaderMisses[offset];
+    misses++;
+    if (misses.isSaturated()) {
+        for (SatCounter16 &counter : leaderMisses) {
+            counter >>= 1;
+        }
+    }
+
+    unsigned best = 0;
+    for (unsigned idx = 1; idx < numIPVs; idx++) {
+        if (leaderMisses[idx] < leaderMisses[best]) {
+            best = idx;
+        }
+    }
+    if (best != followerIPV) {
+        DPRINTF(LruIpv, "Followers switch from IPV %d to IPV %d\n",
+                followerIPV, best);
+        followerIPV = best;
+    }
 }
 
 /**
- * @brief InstantiateEntry: Intializes the replacement data struct for each cache set. It associates
- *         the shared replacement data structure of the set to all the blocks within a cache set.
+ * @brief InstantiateEntry: Intializes the replacement data for each cache block. The
+ *         first block of a set claims the set's recency stack in the flat recency
+ *         array; every block gets a handle to its set and way.
  * 
  * @return std::shared_ptr<ReplacementData> 
  */
 std::shared_ptr<ReplacementData> LRUIPVRP::instantiateEntry()
 {
-    // Generate a shared recency stack per set.
-    if (blockInstanceCounter % numWays == 0) {
-        tempStack = std::make_shared<RecencyStack>(numWays, 0);
-        std::iota(tempStack->begin(), tempStack->end(), 0);
-    }
-
     uint64_t set_id = (uint64_t)(blockInstanceCounter / numWays); 
     uint64_t index = blockInstanceCounter % numWays;
-    auto ipvReplData = std::make_shared<LRUIPVReplData>(set_id, index, tempStack);
+
+    // Generate a recency stack per set, doubling the arrays when they are full.
+    if (index == 0) {
+        if (set_id == recencyCapacity) {
+            growRecency(set_id);
+        }
+        if (compact) {
+            uint64_t packed = 0;
+            for (uint64_t way = 0; way < numWays; way++) {
+                packed |= way << (4 * way);
+            }
+            packedRecency[set_id] = packed;
+            pastEnd[set_id] = 0;
+        } else {
+            uint8_t *stack = setStack(set_id);
+            std::memset(stack, 0, setStride);
+            std::iota(stack, stack + numWays, 0);
+            lruWays[set_id] = uint64_t(1) << (numWays - 1);
+        }
+    }
+
+    if (index == 0) {
+        setUsage.push_back(SetUsage{0, 0, 0});
+    }
+    fillTimes.push_back(0);
+
+    auto ipvReplData = std::make_shared<LRUIPVReplData>(set_id, index);
 
     // Update instance blockInstanceCounter
     blockInstanceCounter++;
@@ -86,61 +214,145 @@ std::shared_ptr<ReplacementData> LRUIPVRP::instantiateEntry()
     return ipvReplData;
 }
 
-/**
- * @brief printSharedState: Helper function to print the recency stack of a set.
- * 
- * @param replacement_data 
- */
-void LRUIPVRP::printSharedState(const std::shared_ptr<ReplacementData>& replacement_data) const {
-    
-    std::shared_ptr<LRUIPVReplData> lru_ipv_replacement_data =
-        std::static_pointer_cast<LRUIPVReplData>(replacement_data);
-    auto stack_ptr = lru_ipv_replacement_data->stack;   
-
-    for (auto iter = stack_ptr->begin(); iter != stack_ptr->end(); iter++) {
-        DPRINTF(LruIpv, "%d ", *iter);
-    }  
-        DPRINTF(LruIpv,"\n");
+void
+LRUIPVRP::growRecency(uint64_t set_id)
+{
+    const uint64_t capacity = recencyCapacity ? 2 * recencyCapacity : 64;
+    assert(set_id < capacity);
+
+    if (compact) {
+        std::unique_ptr<uint64_t[]> grown_packed(new uint64_t[capacity]);
+        std::copy(packedRecency.get(), packedRecency.get() + recencyCapacity,
+                  grown_packed.get());
+        packedRecency = std::move(grown_packed);
+
+        std::unique_ptr<uint16_t[]> grown_past(new uint16_t[capacity]);
+        std::copy(pastEnd.get(), pastEnd.get() + recencyCapacity,
+                  grown_past.get());
+        pastEnd = std::move(grown_past);
+    } else {
+        void *ptr = nullptr;
+        fatal_if(posix_memalign(&ptr, 64, capacity * setStride) != 0,
+                 "Failed to allocate LRU-IPV recency stacks.\n");
+        uint8_t *grown = static_cast<uint8_t *>(ptr);
+        if (recencyCapacity) {
+            std::memcpy(grown, recency.get(), recencyCapacity * setStride);
+        }
+        recency.reset(grown);
+
+        std::unique_ptr<uint64_t[]> grown_lru(new uint64_t[capacity]);
+        std::copy(lruWays.get(), lruWays.get() + recencyCapacity,
+                  grown_lru.get());
+        lruWays = std::move(grown_lru);
+    }
+    recencyCapacity = capacity;
+}
+
+uint64_t
+LRUIPVRP::position(uint64_t set_id, uint64_t way) const
+{
+    if (compact) {
+        return (pastEnd[set_id] >> way) & 1 ?
+            numWays : (packedRecency[set_id] >> (4 * way)) & 0xF;
+    }
+    return setStack(set_id)[way];
+}
+
+void
+LRUIPVRP::promote(uint64_t set_id, uint64_t target, uint64_t new_pos) const
+{
+    if (compact) {
+        lruIpvPromotePacked(packedRecency[set_id], pastEnd[set_id], numWays,
+                            target, new_pos);
+    } else {
+        lruWays[set_id] = lruIpvPromote(setStack(set_id), numWays, setStride,
+                                        target, new_pos);
+    }
+}
+
+void
+LRUIPVRP::demote(uint64_t set_id, uint64_t target) const
+{
+    if (compact) {
+        lruIpvDemotePacked(packedRecency[set_id], pastEnd[set_id], numWays,
+                           target);
+    } else {
+        lruWays[set_id] = lruIpvDemote(setStack(set_id), numWays, setStride,
+                                       target, numWays);
+    }
+}
+
+uint64_t
+LRUIPVRP::lruMask(uint64_t set_id) const
+{
+    return compact ? lruIpvLruMaskPacked(packedRecency[set_id], numWays) :
+        lruWays[set_id];
+}
+
+void
+LRUIPVRP::recordRemoval(uint64_t set_id, uint64_t way) const
+{
+    SetUsage &usage = setUsage[set_id];
+    const uint64_t bit = uint64_t(1) << way;
+    if (!(usage.filledWays & bit)) {
+        return;
+    }
+    stats.evictionAge.sample(usage.accesses - fillTimes[set_id * numWays + way]);
+    if (!(usage.reusedWays & bit)) {
+        stats.deadOnArrival++;
+    }
+    usage.filledWays &= ~bit;
+}
+
+void
+LRUIPVRP::traceEvent(LRUIPVTraceOp op, uint64_t set_id, uint64_t way,
+                     uint64_t old_pos) const
+{
+    if (!traceStream) {
+        traceStream = simout.create(name() + ".ipvtrace", true);
+        LRUIPVTraceHeader header;
+        std::memcpy(header.magic, lruIpvTraceMagic, sizeof(header.magic));
+        header.version = lruIpvTraceVersion;
+        header.numWays = numWays;
+        traceStream->stream()->write(reinterpret_cast<const char *>(&header),
+                                     sizeof(header));
+    }
+
+    LRUIPVTraceEvent event;
+    event.set = set_id;
+    event.way = way;
+    event.oldPos = old_pos;
+    event.newPos = position(set_id, way);
+    event.op = op;
+    traceStream->stream()->write(reinterpret_cast<const char *>(&event),
+                                 sizeof(event));
 }
 
 /**
  * @brief invalidate: Entry point to invalidate a specific block within a set.
  *                    This is achieved by moving the recency value of that 
- *                    block to the MRU position.
+ *                    block past the LRU position.
  * 
  * @param replacement_data 
  */
 void LRUIPVRP::invalidate(const std::shared_ptr<ReplacementData>& replacement_data) const
 {
     // Cast replacement data
-    std::shared_ptr<LRUIPVReplData> lru_ipv_replacement_data =
-        std::static_pointer_cast<LRUIPVReplData>(replacement_data);
-    auto stack_ptr = lru_ipv_replacement_data->stack;
+    const LRUIPVReplData *lru_ipv_replacement_data =
+        static_cast<const LRUIPVReplData *>(replacement_data.get());
     uint64_t block_index = lru_ipv_replacement_data->index;
     uint64_t set_id = lru_ipv_replacement_data->set_id;
     
-    uint64_t target_stack_val = stack_ptr->at(block_index);
+    const uint64_t old_stack_val = position(set_id, block_index);
+    const uint64_t target_stack_val = std::min(old_stack_val, numWays - 1);
+
+    // increase the recency value to invalid, i.e numWays.
+    demote(set_id, target_stack_val);
+    recordRemoval(set_id, block_index);
 
-    if (target_stack_val >= numWays) {
-        target_stack_val = numWays - 1;
+    if (DTRACE(LruIpv)) {
+        traceEvent(LRUIPVTraceInvalidate, set_id, block_index, old_stack_val);
     }
-    DPRINTF(LruIpv,"\ninvalidate:  replacement data index : %d\n", block_index);
-    int i = numWays;
-    uint64_t new_stack_val = numWays;
-    DPRINTF(LruIpv,"\ninvalidate: set_id: %d\n target_stack_val : %d\n",set_id, target_stack_val);
-    DPRINTF(LruIpv,"invalidate: Before modification : \n");
-    // increase the recency value to invalid, i.e 16 in this case.
-    do {
-        i--;
-        uint64_t currBlock_stack_val = stack_ptr->at(i);
-        if (currBlock_stack_val == target_stack_val) {
-            stack_ptr->at(i) = new_stack_val;
-        } else if (currBlock_stack_val > target_stack_val && currBlock_stack_val <= new_stack_val) {
-            stack_ptr->at(i) = currBlock_stack_val - 1;
-        }
-    } while ( i > 0);
-    DPRINTF(LruIpv,"invalidate: After modification : \n");
-    printSharedState(replacement_data);
 }
 
 /**
@@ -152,39 +364,26 @@ void LRUIPVRP::invalidate(const std::shared_ptr<ReplacementData>& replacement_da
 void LRUIPVRP::touch(const std::shared_ptr<ReplacementData>& replacement_data) const
 {
     // Cast replacement data
-    std::shared_ptr<LRUIPVReplData> lru_ipv_replacement_data =
-        std::static_pointer_cast<LRUIPVReplData>(replacement_data);
-    auto stack_ptr = lru_ipv_replacement_data->stack;
+    const LRUIPVReplData *lru_ipv_replacement_data =
+        static_cast<const LRUIPVReplData *>(replacement_data.get());
     uint64_t block_index = lru_ipv_replacement_data->index;
     uint64_t set_id = lru_ipv_replacement_data->set_id;
-    uint64_t target_stack_val = stack_ptr->at(block_index);
 
-    if (target_stack_val >= numWays) {
-        target_stack_val = numWays - 1;
-    }
+    const uint64_t old_stack_val = position(set_id, block_index);
+    const uint64_t target_stack_val = std::min(old_stack_val, numWays - 1);
+    uint64_t new_stack_val = promotionTables[ipvFor(set_id)][target_stack_val];
 
-    uint64_t new_stack_val = promotionVector[target_stack_val];
-    DPRINTF(LruIpv,"\ntouch new_stack_val : %d, old_stack_val: %d\n",new_stack_val, target_stack_val);
-    DPRINTF(LruIpv,"touch: Before modification : \n");
-    printSharedState(replacement_data);
-    DPRINTF(LruIpv,"\ntouch: set_id:%d target_stack_val : %d numWays : %d\n",set_id, target_stack_val, numWays);
-    int i = numWays;
     // Promoting the block's recency value to a new position.
-    do {
-        i--;
-        uint64_t currBlock_stack_val = stack_ptr->at(i);
-        if (currBlock_stack_val >= numWays) {
-            currBlock_stack_val = numWays - 1;
-        }
-        if (currBlock_stack_val == target_stack_val) {
-            stack_ptr->at(i) = new_stack_val;
-        } else if (currBlock_stack_val >= new_stack_val && currBlock_stack_val < target_stack_val) {
-            stack_ptr->at(i) = ++currBlock_stack_val;
-        }
-    } while ( i > 0);
-    DPRINTF(LruIpv,"touch: After modification : \n");
-    printSharedState(replacement_data);
-    DPRINTF(LruIpv,"\n");
+    promote(set_id, target_stack_val, new_stack_val);
+
+    SetUsage &usage = setUsage[set_id];
+    usage.accesses++;
+    usage.reusedWays |= uint64_t(1) << block_index;
+    stats.hitPosition[target_stack_val]++;
+
+    if (DTRACE(LruIpv)) {
+        traceEvent(LRUIPVTraceTouch, set_id, block_index, old_stack_val);
+    }
 }
 
 /**
@@ -194,44 +393,45 @@ void LRUIPVRP::touch(const std::shared_ptr<ReplacementData>& replacement_data) c
  */
 void LRUIPVRP::reset(const std::shared_ptr<ReplacementData>& replacement_data) const
 {
-    std::shared_ptr<LRUIPVReplData> lru_ipv_replacement_data =
-        std::static_pointer_cast<LRUIPVReplData>(replacement_data);
-    auto stack_ptr = lru_ipv_replacement_data->stack;
+    const LRUIPVReplData *lru_ipv_replacement_data =
+        static_cast<const LRUIPVReplData *>(replacement_data.get());
     uint64_t block_index = lru_ipv_replacement_data->index;
     uint64_t set_id = lru_ipv_replacement_data->set_id;
-    uint64_t target_stack_val = stack_ptr->at(block_index);
-    if (target_stack_val >= numWays) {
-        target_stack_val = numWays - 1;
-    }
 
-    uint64_t new_stack_val = promotionVector[16];
-    DPRINTF(LruIpv,"\nreset: new_stack_val : %d\n",new_stack_val);
-    DPRINTF(LruIpv,"\nreset: target_stack_val : %d\n",target_stack_val);
-    DPRINTF(LruIpv,"reset: Before modification : \n");
-    printSharedState(replacement_data);
-    DPRINTF(LruIpv,"\nreset: target_stack_val : %d numWays : %d\n",target_stack_val, numWays);
-    int i = numWays;
+    const uint64_t old_stack_val = position(set_id, block_index);
+    const uint64_t target_stack_val = std::min(old_stack_val, numWays - 1);
+    uint64_t new_stack_val = insertionPositions[ipvFor(set_id)];
+    recordFill(set_id);
+
     // Restting the recency value to a new block position.
-    do {
-        i--;
-        uint64_t currBlock_stack_val = stack_ptr->at(i);
-        if (currBlock_stack_val >= numWays) {
-            currBlock_stack_val = numWays - 1;
-        }
-        if (currBlock_stack_val == target_stack_val) {
-            stack_ptr->at(i) = new_stack_val;
-            DPRINTF(LruIpv,"\reset: set_id:%d tagert_stack_val : %d temp_index : %d\n",set_id, target_stack_val,currBlock_stack_val);
-        } else if (currBlock_stack_val >= new_stack_val && currBlock_stack_val < target_stack_val) {
-            stack_ptr->at(i) = ++currBlock_stack_val;
-        }
-    } while ( i > 0);
-    DPRINTF(LruIpv,"reset: After modification : \n");
-    printSharedState(replacement_data);
-    DPRINTF(LruIpv,"\n");
+    promote(set_id, target_stack_val, new_stack_val);
+
+    // Caches invalidate a block before refilling its way; count a
+    // direct refill as an eviction too.
+    recordRemoval(set_id, block_index);
+    SetUsage &usage = setUsage[set_id];
+    const uint64_t bit = uint64_t(1) << block_index;
+    usage.accesses++;
+    usage.filledWays |= bit;
+    usage.reusedWays &= ~bit;
+    fillTimes[set_id * numWays + block_index] = usage.accesses;
+    stats.fills++;
+    stats.setMisses[set_id]++;
+
+    if (DTRACE(LruIpv)) {
+        traceEvent(LRUIPVTraceReset, set_id, block_index, old_stack_val);
+    }
 }
 
 /**
- * @brief getVictim: Entry point for finding a victim block to be evicted.
+ * @brief getVictim: Entry point for finding a victim block to be evicted. The victim is the
+ *                   last candidate at the LRU position, or the first candidate if none is.
+ *                   A whole set in way order, as set associative indexing hands over, is
+ *                   answered from the set's LRU mask once every candidate is confirmed to
+ *                   be that set's way at its place in the list. Any other candidate list,
+ *                   e.g. one way from each of several sets under skewed indexing, has its
+ *                   positions gathered and compared at once, or scanned one by one past
+ *                   64 candidates.
  * 
  * @param candidates : List of viable candidates for eviction with in a set.
  * @return ReplaceableEntry* 
@@ -240,21 +440,55 @@ ReplaceableEntry* LRUIPVRP::getVictim(const ReplacementCandidates& candidates) c
 {
     // There must be at least one replacement candidate
     assert(candidates.size() > 0);
-    ReplaceableEntry* victim = candidates[0];
-    // Iterate through all candidates and checking which one is at MRU position to get evicted.
-    for (const auto &candidate: candidates) {
-        auto candidate_repl_data = std::static_pointer_cast<LRUIPVReplData>(candidate->replacementData);
-        uint64_t candidate_index = candidate_repl_data->index;
-        auto candidate_stack_ptr = candidate_repl_data->stack;
-        uint64_t candidate_stack_value = candidate_stack_ptr->at(candidate_index);
-        if (candidate_stack_value >= (numWays-1)) {
-            victim = candidate;
-            DPRINTF(LruIpv, "In getVictim. SetID: %d\n", candidate_repl_data->set_id);
-            DPRINTF(LruIpv,"\ngetVictim: victim_index : %d,victim_stack_value : %d\n", candidate_index, candidate_stack_value);
+
+    const uint64_t count = candidates.size();
+    ReplaceableEntry* victim = nullptr;
+    if (count == numWays) {
+        // The set's mask only stands for the list if every candidate is
+        // that set's way at its own place in the list; the check reads
+        // two fields per candidate and takes no references.
+        const uint64_t set_id = static_cast<const LRUIPVReplData *>(
+            candidates[0]->replacementData.get())->set_id;
+        bool whole_set = true;
+        for (uint64_t i = 0; whole_set && i < count; i++) {
+            const LRUIPVReplData *data = static_cast<const LRUIPVReplData *>(
+                candidates[i]->replacementData.get());
+            whole_set = data->set_id == set_id && data->index == i;
+        }
+        if (whole_set) {
+            const uint64_t lru = lruMask(set_id);
+            victim = candidates[lru ? findMsbSet(lru) : 0];
+        }
+    }
+
+    if (!victim && count <= 64) {
+        // Candidates from several sets or a partial set: gather their
+        // positions and compare them together.
+        alignas(16) uint8_t positions[64] = {};
+        for (uint64_t i = 0; i < count; i++) {
+            const LRUIPVReplData *data = static_cast<const LRUIPVReplData *>(
+                candidates[i]->replacementData.get());
+            positions[i] = position(data->set_id, data->index);
+        }
+        const uint64_t lru = lruIpvLruMask(positions, count, numWays);
+        victim = candidates[lru ? findMsbSet(lru) : 0];
+    } else if (!victim) {
+        victim = candidates[0];
+        for (ReplaceableEntry* candidate : candidates) {
+            const LRUIPVReplData *data = static_cast<const LRUIPVReplData *>(
+                candidate->replacementData.get());
+            if (position(data->set_id, data->index) >= numWays - 1) {
+                victim = candidate;
+            }
         }
-        DPRINTF(LruIpv,"\ngetVictim: candidate_index : %d, stack_size : %d\n",candidate_index, candidate_stack_ptr->size());
     }
 
+    if (DTRACE(LruIpv)) {
+        const LRUIPVReplData *data = static_cast<const LRUIPVReplData *>(
+            victim->replacementData.get());
+        traceEvent(LRUIPVTraceVictim, data->set_id, data->index,
+                   position(data->set_id, data->index));
+    }
     return victim;
 }
 
@@ -35,11 +35,18 @@
 #ifndef __MEM_CACHE_REPLACEMENT_POLICIES_LRU_IPV_HH__
 #define __MEM_CACHE_REPLACEMENT_POLICIES_LRU_IPV_HH__
 
+#include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <vector>
 
+#include "base/sat_counter.hh"
+#include "base/statistics.hh"
 #include "mem/cache/replacement_policies/base.hh"
+#include "mem/cache/replacement_policies/lru_ipv_trace.hh"
 #include "params/LRUIPVRP.hh"
 
+class OutputStream;
 struct LRUIPVRPParams;
 
 namespace ReplacementPolicy {
@@ -48,34 +55,182 @@ namespace ReplacementPolicy {
 class LRUIPVRP : public Base
 {
   private:
-    typedef std::vector<int> RecencyStack;
+    /** Frees memory obtained from posix_memalign(). */
+    struct AlignedFree
+    {
+        void operator()(uint8_t *ptr) const { free(ptr); }
+    };
 
     const uint64_t numWays;
 
+    /**
+     * Bytes of recency storage per set: numWays rounded up to a power of
+     * 2 so that no set straddles a cache line.
+     */
+    const uint64_t setStride;
+
     uint64_t blockInstanceCounter;
 
-    std::shared_ptr<RecencyStack> tempStack;
+    /**
+     * Recency stack position of every block, setStride bytes per set,
+     * in one cache line aligned allocation. It grows as entries are
+     * instantiated; blocks refer to it by set and way, never by
+     * pointer, so it can be moved.
+     */
+    std::unique_ptr<uint8_t[], AlignedFree> recency;
+
+    /**
+     * Per set, a bit for each way whose recency position is at least
+     * numWays - 1, kept up to date by every stack update so that
+     * getVictim() never has to look at the stack. Grows with recency.
+     */
+    std::unique_ptr<uint64_t[]> lruWays;
 
-    std::vector<int> promotionVector;
+    /**
+     * With compactRecency, the recency state instead lives here: per
+     * set, each way's position clamped to numWays - 1 in 4 bits, and a
+     * bit per way whose position is numWays. The LRU mask is derived
+     * from the nibbles, so recency and lruWays stay empty.
+     */
+    const bool compact;
+    std::unique_ptr<uint64_t[]> packedRecency;
+    std::unique_ptr<uint16_t[]> pastEnd;
 
-    void printSharedState(const std::shared_ptr<ReplacementData>& replacement_data) const;
+    /** Sets the recency arrays have room for. */
+    uint64_t recencyCapacity;
 
-  protected:
-    /** LRUIPVRP-specific implementation of replacement data. */
-    struct LRUIPVReplData : ReplacementData
+    /**
+     * Per IPV, where a touched block moves to, indexed by its current
+     * stack position. Each table has numWays + 1 entries so that
+     * invalidated blocks, which sit past the end of the stack, promote
+     * like the LRU block. IPV 0 is ipv, the others duelingIPVs.
+     */
+    std::vector<std::vector<uint8_t>> promotionTables;
+
+    /** Per IPV, the stack position new blocks are inserted at. */
+    std::vector<uint8_t> insertionPositions;
+
+    /**
+     * With more than one IPV, the first numIPVs sets of every
+     * constituency of duelingConstituency sets lead for one IPV each
+     * and the other sets follow the IPV whose leaders miss least.
+     */
+    const unsigned numIPVs;
+    const uint64_t constituencyMask;
+
+    /** Fills in each IPV's leader sets, aged by halving. */
+    mutable std::vector<SatCounter16> leaderMisses;
+
+    /** IPV the follower sets use. */
+    mutable unsigned followerIPV;
+
+    /** Validate an IPV and add its tables. */
+    void addIPV(const std::vector<unsigned> &ipv);
+
+    /** IPV a set is using: a constant mask test, then a load. */
+    unsigned
+    ipvFor(uint64_t set_id) const
+    {
+        const uint64_t offset = set_id & constituencyMask;
+        return offset < numIPVs ? offset : followerIPV;
+    }
+
+    /** Count a fill in a set; leader fills steer the followers. */
+    void recordFill(uint64_t set_id) const;
+
+    /** Recency stack of a set. */
+    uint8_t *
+    setStack(uint64_t set_id) const
     {
-        const uint64_t set_id;
+        return recency.get() + set_id * setStride;
+    }
 
-        const uint64_t index;
+    /** Recency position of a block, numWays if invalidated. */
+    uint64_t position(uint64_t set_id, uint64_t way) const;
 
+    /** Grow the recency arrays to hold at least set_id + 1 sets. */
+    void growRecency(uint64_t set_id);
 
-        std::shared_ptr<RecencyStack> stack;
+    /**
+     * Move the blocks at position target, which is at most numWays - 1,
+     * to new_pos and shift the ones in between, in either layout.
+     * Demotion to numWays invalidates.
+     */
+    void promote(uint64_t set_id, uint64_t target, uint64_t new_pos) const;
+    void demote(uint64_t set_id, uint64_t target) const;
+
+    /** Ways at the LRU position of a set. */
+    uint64_t lruMask(uint64_t set_id) const;
+
+    /**
+     * Per-set bookkeeping behind the reuse statistics, kept alongside
+     * the recency state and updated on the same paths.
+     */
+    struct SetUsage
+    {
+        /** Ways holding a filled block. */
+        uint64_t filledWays;
+        /** Ways hit since they were filled. */
+        uint64_t reusedWays;
+        /** Hits and fills in the set: the clock block ages count in. */
+        uint32_t accesses;
+    };
+    mutable std::vector<SetUsage> setUsage;
+
+    /** Per block, the set's access count when it was filled. */
+    mutable std::vector<uint32_t> fillTimes;
+
+    /** Account for a filled block leaving its set. */
+    void recordRemoval(uint64_t set_id, uint64_t way) const;
+
+    /** Binary event log, opened on the first traced event. */
+    mutable OutputStream *traceStream;
+
+    /**
+     * Log an update of a block that was at old_pos; its new position is
+     * read back from the set. Callers check the LruIpv flag first, so
+     * this costs nothing when tracing is off or compiled out.
+     */
+    void traceEvent(LRUIPVTraceOp op, uint64_t set_id, uint64_t way,
+                    uint64_t old_pos) const;
+
+  protected:
+    /**
+     * LRUIPVRP-specific implementation of replacement data: a handle
+     * to the block's entry in the policy's recency array.
+     */
+    struct LRUIPVReplData : ReplacementData
+    {
+        const uint32_t set_id;
+
+        const uint32_t index;
 
         /**
          * Default constructor. Invalidate data.
          */
-        LRUIPVReplData(const uint64_t set_id, const uint64_t index, std::shared_ptr<RecencyStack> stack);
+        LRUIPVReplData(const uint32_t set_id, const uint32_t index);
+    };
+
+    struct LRUIPVRPStats : public Stats::Group
+    {
+        LRUIPVRPStats(LRUIPVRP &policy);
+
+        void regStats() override;
+
+        const LRUIPVRP &policy;
+
+        /** Hits by the recency position the block was found at. */
+        Stats::Vector hitPosition;
+        /** Blocks inserted. */
+        Stats::Scalar fills;
+        /** Blocks that left the cache without a hit since their fill. */
+        Stats::Scalar deadOnArrival;
+        /** Accesses to its set between a block's fill and its eviction. */
+        Stats::Histogram evictionAge;
+        /** Fills, i.e. misses, per set. */
+        Stats::Vector setMisses;
     };
+    mutable LRUIPVRPStats stats;
 
   public:
     typedef LRUIPVRPParams Params;
@@ -0,0 +1,522 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Whole-set recency stack updates for the LRU-IPV replacement policy.
+ *
+ * Every update moves one stack position and shifts the positions in
+ * between by one, so each entry's new value only depends on its old one.
+ * The vector versions apply that rule to 16 (SSE2) or 32 (AVX2) ways per
+ * instruction; the scalar versions are the reference loops and handle
+ * sets narrower than a vector.
+ *
+ * Each update also returns the set's LRU mask, the ways whose position is
+ * at least num_ways - 1, which is what victim selection looks at.
+ *
+ * Sets of up to 16 ways can also be kept packed, 4 bits per way in one
+ * 64-bit word. Those are updated 8 ways at a time in the bytes of a
+ * 64-bit register, even and odd ways in turn, using PEXT/PDEP to turn
+ * per-way flags into bit masks where BMI2 is available and shifts and
+ * masks elsewhere.
+ *
+ * The default insertion/promotion vector lives here as well, so that
+ * the standalone cache models share it with the policy.
+ */
+
+#ifndef __MEM_CACHE_REPLACEMENT_POLICIES_LRU_IPV_KERNELS_HH__
+#define __MEM_CACHE_REPLACEMENT_POLICIES_LRU_IPV_KERNELS_HH__
+
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__) || defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace ReplacementPolicy {
+
+/**
+ * Promote the blocks at stack position target to new_pos, moving the
+ * blocks in [new_pos, target) one position towards LRU. Positions are
+ * clamped to num_ways - 1 before they are compared, so invalidated
+ * blocks count as LRU.
+ *
+ * @param stack Recency positions of the set, one byte per way.
+ * @param num_ways Ways in the set.
+ * @param target Position being promoted, at most num_ways - 1.
+ * @param new_pos Position it is promoted to.
+ * @return The LRU mask after the update.
+ */
+inline uint64_t
+lruIpvPromoteScalar(uint8_t *stack, unsigned num_ways, unsigned target,
+                    unsigned new_pos)
+{
+    uint64_t lru = 0;
+    for (unsigned i = 0; i < num_ways; i++) {
+        unsigned val = stack[i];
+        if (val >= num_ways) {
+            val = num_ways - 1;
+        }
+        if (val == target) {
+            stack[i] = new_pos;
+        } else if (val >= new_pos && val < target) {
+            stack[i] = val + 1;
+        }
+        lru |= uint64_t(stack[i] >= num_ways - 1) << i;
+    }
+    return lru;
+}
+
+/**
+ * Move the blocks at stack position target to new_pos, past the end of
+ * the stack, moving the blocks in (target, new_pos] one position
+ * towards MRU. Positions are compared unclamped.
+ *
+ * @param stack Recency positions of the set, one byte per way.
+ * @param num_ways Ways in the set.
+ * @param target Position being invalidated, at most num_ways - 1.
+ * @param new_pos Invalid position it moves to.
+ * @return The LRU mask after the update.
+ */
+inline uint64_t
+lruIpvDemoteScalar(uint8_t *stack, unsigned num_ways, unsigned target,
+                   unsigned new_pos)
+{
+    uint64_t lru = 0;
+    for (unsigned i = 0; i < num_ways; i++) {
+        const unsigned val = stack[i];
+        if (val == target) {
+            stack[i] = new_pos;
+        } else if (val > target && val <= new_pos) {
+            stack[i] = val - 1;
+        }
+        lru |= uint64_t(stack[i] >= num_ways - 1) << i;
+    }
+    return lru;
+}
+
+/**
+ * LRU mask of a list of positions, e.g. gathered from the candidates of
+ * a victim search.
+ *
+ * @param positions Positions, padded with zeroes to a multiple of 16
+ * bytes and 16-byte aligned.
+ * @param count Number of positions, at most 64.
+ * @param num_ways Ways per set.
+ */
+inline uint64_t
+lruIpvLruMaskScalar(const uint8_t *positions, unsigned count,
+                    unsigned num_ways)
+{
+    uint64_t lru = 0;
+    for (unsigned i = 0; i < count; i++) {
+        lru |= uint64_t(positions[i] >= num_ways - 1) << i;
+    }
+    return lru;
+}
+
+#if defined(__SSE2__)
+
+/** Lanes of a 16-way chunk starting at way base that are below num_ways. */
+inline __m128i
+lruIpvLaneMask128(unsigned base, unsigned num_ways)
+{
+    const __m128i lanes = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+                                        11, 12, 13, 14, 15);
+    const int left = num_ways - base;
+    // Signed compare is fine, both sides are below 128.
+    return _mm_cmplt_epi8(lanes, _mm_set1_epi8(left > 16 ? 16 : left));
+}
+
+inline __m128i
+lruIpvSelect128(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/** Bits of the lanes at or past last, within the lanes in lanes. */
+inline uint64_t
+lruIpvLruBits128(__m128i val, __m128i last, __m128i lanes)
+{
+    const __m128i at_lru = _mm_cmpeq_epi8(_mm_max_epu8(val, last), val);
+    return (unsigned)_mm_movemask_epi8(_mm_and_si128(at_lru, lanes));
+}
+
+#endif
+
+#if defined(__AVX2__)
+
+inline __m256i
+lruIpvLaneMask256(unsigned base, unsigned num_ways)
+{
+    const __m256i lanes = _mm256_setr_epi8(
+        0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+        16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+    const int left = num_ways - base;
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8(left > 32 ? 32 : left), lanes);
+}
+
+inline uint64_t
+lruIpvLruBits256(__m256i val, __m256i last, __m256i lanes)
+{
+    const __m256i at_lru =
+        _mm256_cmpeq_epi8(_mm256_max_epu8(val, last), val);
+    return (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(at_lru, lanes));
+}
+
+#endif
+
+/**
+ * Vector version of lruIpvPromoteScalar(). Sets at least 16 ways wide
+ * are updated a vector at a time; stride is the bytes reserved per set
+ * and must be a multiple of the vector width used.
+ */
+inline uint64_t
+lruIpvPromote(uint8_t *stack, unsigned num_ways, unsigned stride,
+              unsigned target, unsigned new_pos)
+{
+#if defined(__SSE2__)
+    if (stride < 16) {
+        return lruIpvPromoteScalar(stack, num_ways, target, new_pos);
+    }
+    uint64_t lru = 0;
+    unsigned base = 0;
+#if defined(__AVX2__)
+    if (stride % 32 == 0) {
+        const __m256i last = _mm256_set1_epi8(num_ways - 1);
+        const __m256i tgt = _mm256_set1_epi8(target);
+        const __m256i pos = _mm256_set1_epi8(new_pos);
+        const __m256i one = _mm256_set1_epi8(1);
+        for (; base < num_ways; base += 32) {
+            __m256i *ptr = reinterpret_cast<__m256i *>(stack + base);
+            const __m256i lanes = lruIpvLaneMask256(base, num_ways);
+            const __m256i old = _mm256_load_si256(ptr);
+            const __m256i val = _mm256_min_epu8(old, last);
+            const __m256i is_tgt = _mm256_cmpeq_epi8(val, tgt);
+            const __m256i ge_pos =
+                _mm256_cmpeq_epi8(_mm256_max_epu8(val, pos), val);
+            const __m256i ge_tgt =
+                _mm256_cmpeq_epi8(_mm256_max_epu8(val, tgt), val);
+            const __m256i shift = _mm256_andnot_si256(ge_tgt, ge_pos);
+            __m256i res = _mm256_blendv_epi8(old, _mm256_add_epi8(val, one),
+                                             shift);
+            res = _mm256_blendv_epi8(res, pos, is_tgt);
+            res = _mm256_blendv_epi8(old, res, lanes);
+            _mm256_store_si256(ptr, res);
+            lru |= lruIpvLruBits256(res, last, lanes) << base;
+        }
+        return lru;
+    }
+#endif
+    const __m128i last = _mm_set1_epi8(num_ways - 1);
+    const __m128i tgt = _mm_set1_epi8(target);
+    const __m128i pos = _mm_set1_epi8(new_pos);
+    const __m128i one = _mm_set1_epi8(1);
+    for (; base < num_ways; base += 16) {
+        __m128i *ptr = reinterpret_cast<__m128i *>(stack + base);
+        const __m128i lanes = lruIpvLaneMask128(base, num_ways);
+        const __m128i old = _mm_load_si128(ptr);
+        const __m128i val = _mm_min_epu8(old, last);
+        const __m128i is_tgt = _mm_cmpeq_epi8(val, tgt);
+        const __m128i ge_pos = _mm_cmpeq_epi8(_mm_max_epu8(val, pos), val);
+        const __m128i ge_tgt = _mm_cmpeq_epi8(_mm_max_epu8(val, tgt), val);
+        const __m128i shift = _mm_andnot_si128(ge_tgt, ge_pos);
+        __m128i res = lruIpvSelect128(shift, _mm_add_epi8(val, one), old);
+        res = lruIpvSelect128(is_tgt, pos, res);
+        res = lruIpvSelect128(lanes, res, old);
+        _mm_store_si128(ptr, res);
+        lru |= lruIpvLruBits128(res, last, lanes) << base;
+    }
+    return lru;
+#else
+    (void)stride;
+    return lruIpvPromoteScalar(stack, num_ways, target, new_pos);
+#endif
+}
+
+/**
+ * Vector version of lruIpvDemoteScalar(), with the same constraints as
+ * lruIpvPromote().
+ */
+inline uint64_t
+lruIpvDemote(uint8_t *stack, unsigned num_ways, unsigned stride,
+             unsigned target, unsigned new_pos)
+{
+#if defined(__SSE2__)
+    if (stride < 16) {
+        return lruIpvDemoteScalar(stack, num_ways, target, new_pos);
+    }
+    uint64_t lru = 0;
+    unsigned base = 0;
+#if defined(__AVX2__)
+    if (stride % 32 == 0) {
+        const __m256i last = _mm256_set1_epi8(num_ways - 1);
+        const __m256i tgt = _mm256_set1_epi8(target);
+        const __m256i pos = _mm256_set1_epi8(new_pos);
+        const __m256i one = _mm256_set1_epi8(1);
+        for (; base < num_ways; base += 32) {
+            __m256i *ptr = reinterpret_cast<__m256i *>(stack + base);
+            const __m256i lanes = lruIpvLaneMask256(base, num_ways);
+            const __m256i old = _mm256_load_si256(ptr);
+            const __m256i is_tgt = _mm256_cmpeq_epi8(old, tgt);
+            const __m256i le_tgt =
+                _mm256_cmpeq_epi8(_mm256_max_epu8(old, tgt), tgt);
+            const __m256i le_pos =
+                _mm256_cmpeq_epi8(_mm256_min_epu8(old, pos), old);
+            const __m256i shift = _mm256_andnot_si256(le_tgt, le_pos);
+            __m256i res = _mm256_blendv_epi8(old, _mm256_sub_epi8(old, one),
+                                             shift);
+            res = _mm256_blendv_epi8(res, pos, is_tgt);
+            res = _mm256_blendv_epi8(old, res, lanes);
+            _mm256_store_si256(ptr, res);
+            lru |= lruIpvLruBits256(res, last, lanes) << base;
+        }
+        return lru;
+    }
+#endif
+    const __m128i last = _mm_set1_epi8(num_ways - 1);
+    const __m128i tgt = _mm_set1_epi8(target);
+    const __m128i pos = _mm_set1_epi8(new_pos);
+    const __m128i one = _mm_set1_epi8(1);
+    for (; base < num_ways; base += 16) {
+        __m128i *ptr = reinterpret_cast<__m128i *>(stack + base);
+        const __m128i lanes = lruIpvLaneMask128(base, num_ways);
+        const __m128i old = _mm_load_si128(ptr);
+        const __m128i is_tgt = _mm_cmpeq_epi8(old, tgt);
+        const __m128i le_tgt = _mm_cmpeq_epi8(_mm_max_epu8(old, tgt), tgt);
+        const __m128i le_pos = _mm_cmpeq_epi8(_mm_min_epu8(old, pos), old);
+        const __m128i shift = _mm_andnot_si128(le_tgt, le_pos);
+        __m128i res = lruIpvSelect128(shift, _mm_sub_epi8(old, one), old);
+        res = lruIpvSelect128(is_tgt, pos, res);
+        res = lruIpvSelect128(lanes, res, old);
+        _mm_store_si128(ptr, res);
+        lru |= lruIpvLruBits128(res, last, lanes) << base;
+    }
+    return lru;
+#else
+    (void)stride;
+    return lruIpvDemoteScalar(stack, num_ways, target, new_pos);
+#endif
+}
+
+/** Vector version of lruIpvLruMaskScalar(). */
+inline uint64_t
+lruIpvLruMask(const uint8_t *positions, unsigned count, unsigned num_ways)
+{
+#if defined(__SSE2__)
+    const __m128i last = _mm_set1_epi8(num_ways - 1);
+    uint64_t lru = 0;
+    for (unsigned base = 0; base < count; base += 16) {
+        const __m128i val = _mm_load_si128(
+            reinterpret_cast<const __m128i *>(positions + base));
+        lru |= lruIpvLruBits128(val, last, lruIpvLaneMask128(base, count))
+            << base;
+    }
+    return lru;
+#else
+    return lruIpvLruMaskScalar(positions, count, num_ways);
+#endif
+}
+
+/** Byte lane constants of the packed updates. */
+constexpr uint64_t lruIpvByteOnes = 0x0101010101010101ULL;
+constexpr uint64_t lruIpvByteHighs = 0x8080808080808080ULL;
+constexpr uint64_t lruIpvByteNibbles = 0x0F0F0F0F0F0F0F0FULL;
+
+/**
+ * One bit per way from a flag in the top bit of each way's nibble, as
+ * built by merging the even and odd byte lanes.
+ */
+inline unsigned
+lruIpvWayBits(uint64_t flags)
+{
+#if defined(__BMI2__)
+    return _pext_u64(flags, 0x8888888888888888ULL);
+#else
+    uint64_t x = (flags >> 3) & 0x1111111111111111ULL;
+    x = (x | x >> 3) & 0x0303030303030303ULL;
+    x = (x | x >> 6) & 0x000F000F000F000FULL;
+    x = (x | x >> 12) & 0x000000FF000000FFULL;
+    return (x | x >> 24) & 0xFFFF;
+#endif
+}
+
+/** Inverse of lruIpvWayBits(). */
+inline uint64_t
+lruIpvWayFlags(unsigned bits)
+{
+#if defined(__BMI2__)
+    return _pdep_u64(bits, 0x8888888888888888ULL);
+#else
+    uint64_t x = bits & 0xFFFF;
+    x = (x | x << 24) & 0x000000FF000000FFULL;
+    x = (x | x << 12) & 0x000F000F000F000FULL;
+    x = (x | x << 6) & 0x0303030303030303ULL;
+    x = (x | x << 3) & 0x1111111111111111ULL;
+    return x << 3;
+#endif
+}
+
+/**
+ * High bit of every byte lane holding at least val. Lanes must be below
+ * 128 and val at most 128.
+ */
+inline uint64_t
+lruIpvLanesAtLeast(uint64_t lanes, unsigned val)
+{
+    return ((lanes | lruIpvByteHighs) - val * lruIpvByteOnes) &
+        lruIpvByteHighs;
+}
+
+/** Whole bytes of the lanes flagged by lruIpvLanesAtLeast(). */
+inline uint64_t
+lruIpvLaneFill(uint64_t flags)
+{
+    return (flags >> 7) * 0xFF;
+}
+
+/**
+ * Byte lanes of the even (odd = 0) or odd (odd = 1) ways of a packed
+ * set, and their flags moved back to the top bit of each way's nibble.
+ */
+inline uint64_t
+lruIpvPackedLanes(uint64_t packed, unsigned odd)
+{
+    return (packed >> (4 * odd)) & lruIpvByteNibbles;
+}
+
+inline uint64_t
+lruIpvNibbleFlags(uint64_t flags, unsigned odd)
+{
+    return flags >> (4 * (1 - odd));
+}
+
+/**
+ * lruIpvPromoteScalar() on a set of at most 16 ways packed 4 bits per
+ * way, way 0 in the low bits. Nibbles hold positions clamped to
+ * num_ways - 1, the clamp a promotion applies anyway; past_end has a
+ * bit for each way whose position is num_ways, which promotion clears.
+ * Unlike the byte stack versions this does not return the LRU mask;
+ * lruIpvLruMaskPacked() derives it when it is needed.
+ */
+inline void
+lruIpvPromotePacked(uint64_t &packed, uint16_t &past_end, unsigned num_ways,
+                    unsigned target, unsigned new_pos)
+{
+    uint64_t result = 0;
+    uint64_t moved = 0;
+    for (unsigned odd = 0; odd < 2; odd++) {
+        const uint64_t val = lruIpvPackedLanes(packed, odd);
+        const uint64_t ge_tgt = lruIpvLanesAtLeast(val, target);
+        const uint64_t is_tgt =
+            ge_tgt & ~lruIpvLanesAtLeast(val, target + 1);
+        const uint64_t shift = lruIpvLanesAtLeast(val, new_pos) & ~ge_tgt;
+        uint64_t res = val + (shift >> 7);
+        res = (res & ~lruIpvLaneFill(is_tgt)) |
+            (new_pos * lruIpvByteOnes & lruIpvLaneFill(is_tgt));
+        result |= res << (4 * odd);
+        moved |= lruIpvNibbleFlags(is_tgt, odd);
+    }
+    packed = result & (~uint64_t(0) >> (64 - 4 * num_ways));
+    if (past_end) {
+        past_end &= ~lruIpvWayBits(moved);
+    }
+}
+
+/**
+ * lruIpvDemoteScalar() on a packed set, moving position target to
+ * num_ways; see lruIpvPromotePacked() for the layout.
+ */
+inline void
+lruIpvDemotePacked(uint64_t &packed, uint16_t &past_end, unsigned num_ways,
+                   unsigned target)
+{
+    // Ways already past the end read as num_ways - 1 here but are
+    // really num_ways: they step back onto the stack instead.
+    const uint64_t beyond = past_end ? lruIpvWayFlags(past_end) : 0;
+    uint64_t result = 0;
+    uint64_t demoted = 0;
+    for (unsigned odd = 0; odd < 2; odd++) {
+        const uint64_t val = lruIpvPackedLanes(packed, odd);
+        const uint64_t lane_beyond =
+            (beyond << (4 * (1 - odd))) & lruIpvByteHighs;
+        const uint64_t gt_tgt = lruIpvLanesAtLeast(val, target + 1);
+        const uint64_t is_tgt =
+            lruIpvLanesAtLeast(val, target) & ~gt_tgt & ~lane_beyond;
+        const uint64_t shift = gt_tgt & ~lane_beyond;
+        uint64_t res = val - (shift >> 7);
+        res = (res & ~lruIpvLaneFill(is_tgt)) |
+            ((num_ways - 1) * lruIpvByteOnes & lruIpvLaneFill(is_tgt));
+        result |= res << (4 * odd);
+        demoted |= lruIpvNibbleFlags(is_tgt, odd);
+    }
+    packed = result & (~uint64_t(0) >> (64 - 4 * num_ways));
+    past_end = lruIpvWayBits(demoted) & ((1U << num_ways) - 1);
+}
+
+/** LRU mask of a packed set. */
+inline uint64_t
+lruIpvLruMaskPacked(uint64_t packed, unsigned num_ways)
+{
+    uint64_t flags = 0;
+    for (unsigned odd = 0; odd < 2; odd++) {
+        flags |= lruIpvNibbleFlags(
+            lruIpvLanesAtLeast(lruIpvPackedLanes(packed, odd), num_ways - 1),
+            odd);
+    }
+    return lruIpvWayBits(flags) & ((uint64_t(1) << num_ways) - 1);
+}
+
+/**
+ * IPV used when none is given: the vector from the IPV paper for 16
+ * ways, rescaled to the associativity otherwise. Entry i is the
+ * position a hit at position i promotes to; entry num_ways is the
+ * insertion position.
+ */
+inline std::vector<unsigned>
+lruIpvDefaultIPV(unsigned num_ways)
+{
+    static const unsigned paperIPV[] =
+        {0, 0, 1, 0, 3, 0, 1, 2, 1, 0, 5, 1, 0, 0, 1, 11, 13};
+
+    std::vector<unsigned> ipv(num_ways + 1);
+    for (unsigned pos = 0; pos < num_ways; pos++) {
+        // Never promotes a block towards LRU, as paperIPV[i] <= i.
+        ipv[pos] = paperIPV[pos * 16 / num_ways] * num_ways / 16;
+    }
+    ipv[num_ways] = paperIPV[16] * num_ways / 16;
+    return ipv;
+}
+
+} // namespace ReplacementPolicy
+
+#endif // __MEM_CACHE_REPLACEMENT_POLICIES_LRU_IPV_KERNELS_HH__
@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Record layout of the binary event log LRUIPVRP writes when the LruIpv
+ * debug flag is on. It has no gem5 dependencies so that offline tools
+ * can read the log; fields are in host byte order.
+ */
+
+#ifndef __MEM_CACHE_REPLACEMENT_POLICIES_LRU_IPV_TRACE_HH__
+#define __MEM_CACHE_REPLACEMENT_POLICIES_LRU_IPV_TRACE_HH__
+
+#include <cstdint>
+
+namespace ReplacementPolicy {
+
+/** Operations recorded in the log. */
+enum LRUIPVTraceOp : uint8_t
+{
+    LRUIPVTraceTouch,
+    LRUIPVTraceReset,
+    LRUIPVTraceInvalidate,
+    LRUIPVTraceVictim,
+    NumLRUIPVTraceOps
+};
+
+inline const char *
+lruIpvTraceOpName(unsigned op)
+{
+    static const char *const names[] =
+        {"touch", "reset", "invalidate", "victim"};
+    return op < NumLRUIPVTraceOps ? names[op] : "unknown";
+}
+
+/** Start of the log. */
+struct LRUIPVTraceHeader
+{
+    /** "IPVTRACE". */
+    char magic[8];
+    uint32_t version;
+    uint32_t numWays;
+};
+
+/**
+ * One recency update: the block at set and way moved from oldPos to
+ * newPos, where numWays stands for an invalidated block. Victim events
+ * record the chosen block with its position in both fields.
+ */
+struct LRUIPVTraceEvent
+{
+    uint32_t set;
+    uint8_t way;
+    uint8_t oldPos;
+    uint8_t newPos;
+    uint8_t op;
+};
+
+static_assert(sizeof(LRUIPVTraceHeader) == 16, "unexpected padding");
+static_assert(sizeof(LRUIPVTraceEvent) == 8, "unexpected padding");
+
+constexpr char lruIpvTraceMagic[8] =
+    {'I', 'P', 'V', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t lruIpvTraceVersion = 1;
+
+} // namespace ReplacementPolicy
+
+#endif // __MEM_CACHE_REPLACEMENT_POLICIES_LRU_IPV_TRACE_HH__
@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Loading and generation of memory address streams.
+ */
+
+#include "address_stream.hh"
+
+#include <cstdlib>
+#include <fstream>
+#include <random>
+
+bool
+loadAddressStream(const std::string &path, std::vector<uint64_t> &addrs,
+                  std::string &err)
+{
+    std::ifstream in(path);
+    if (!in) {
+        err = "cannot open " + path;
+        return false;
+    }
+
+    std::string line;
+    unsigned long line_no = 0;
+    while (std::getline(in, line)) {
+        line_no++;
+        const char *p = line.c_str();
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '\0' || *p == '#') {
+            continue;
+        }
+        if ((*p == 'R' || *p == 'W') && (p[1] == ' ' || p[1] == '\t')) {
+            p += 2;
+        }
+
+        char *end;
+        const uint64_t addr = std::strtoull(p, &end, 16);
+        if (end == p) {
+            err = path + ":" + std::to_string(line_no) +
+                ": expected an address";
+            return false;
+        }
+        addrs.push_back(addr);
+    }
+    return true;
+}
+
+void
+synthesizeAddressStream(uint64_t count, uint64_t seed, uint64_t footprint,
+                        std::vector<uint64_t> &addrs)
+{
+    const uint64_t block = 64;
+    const uint64_t hot_blocks = 16 * 1024;
+    const uint64_t loop_blocks = 40 * 1024;
+    const uint64_t scan_blocks = footprint / block ? footprint / block : 1;
+    // Keep the components in disjoint regions.
+    const uint64_t loop_base = hot_blocks * block;
+    const uint64_t scan_base = loop_base + loop_blocks * block;
+
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<uint64_t> hot(0, hot_blocks - 1);
+    std::uniform_int_distribution<uint64_t> scan(0, scan_blocks - 1);
+    std::uniform_int_distribution<unsigned> pick(0, 99);
+
+    addrs.reserve(addrs.size() + count);
+    uint64_t loop_pos = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        const unsigned kind = pick(rng);
+        if (kind < 60) {
+            addrs.push_back(hot(rng) * block);
+        } else if (kind < 85) {
+            addrs.push_back(loop_base + loop_pos * block);
+            loop_pos = (loop_pos + 1) % loop_blocks;
+        } else {
+            addrs.push_back(scan_base + scan(rng) * block);
+        }
+    }
+}
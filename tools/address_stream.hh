@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Memory address streams for the standalone replacement policy tools.
+ */
+
+#ifndef __TOOLS_ADDRESS_STREAM_HH__
+#define __TOOLS_ADDRESS_STREAM_HH__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Load a whole address stream into memory.
+ *
+ * Text traces hold one access per line, the address in hex optionally
+ * preceded by an 'R' or 'W' that is ignored. Blank lines and lines
+ * starting with '#' are skipped.
+ *
+ * @param path Trace file to read.
+ * @param addrs Filled with the addresses.
+ * @param err Set to a description of the problem on failure.
+ * @return Whether the trace was read successfully.
+ */
+bool loadAddressStream(const std::string &path, std::vector<uint64_t> &addrs,
+                       std::string &err);
+
+/**
+ * Generate a reproducible stream mixing the access patterns replacement
+ * policies are usually judged on: a small hot set reused at random, a
+ * loop slightly larger than a typical LLC and a uniform scan over a
+ * large footprint.
+ *
+ * @param count Number of accesses.
+ * @param seed Random seed.
+ * @param footprint Bytes covered by the scan component.
+ * @param addrs Filled with the addresses, 64-byte aligned.
+ */
+void synthesizeAddressStream(uint64_t count, uint64_t seed,
+                             uint64_t footprint,
+                             std::vector<uint64_t> &addrs);
+
+#endif // __TOOLS_ADDRESS_STREAM_HH__
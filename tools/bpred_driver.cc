@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A minimal front end that drives a BPredUnit direction predictor from a
+ * recorded branch stream.
+ */
+
+#include "bpred_driver.hh"
+
+#include "base/bitfield.hh"
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+BPredDriver::BPredDriver(BPredUnit &bp, unsigned btb_entries,
+                         unsigned btb_tag_bits, unsigned inst_shift_amt)
+    : bp(bp), btb(btb_entries), instShiftAmt(inst_shift_amt)
+{
+    if (!isPowerOf2(btb_entries)) {
+        fatal("BTB entries is not a power of 2.\n");
+    }
+    btbIdxMask = btb_entries - 1;
+    btbTagShiftAmt = instShiftAmt + floorLog2(btb_entries);
+    btbTagMask = mask(btb_tag_bits);
+}
+
+void
+BPredDriver::serialize(CheckpointOut &cp) const
+{
+    const uint64_t branches = position;
+    SERIALIZE_SCALAR(branches);
+
+    std::vector<uint64_t> tags;
+    std::vector<uint64_t> targets;
+    std::vector<unsigned> tids;
+    std::vector<unsigned> valid;
+    for (const BTBEntry &entry : btb) {
+        tags.push_back(entry.tag);
+        targets.push_back(entry.target);
+        tids.push_back(entry.tid);
+        valid.push_back(entry.valid);
+    }
+    SERIALIZE_CONTAINER(tags);
+    SERIALIZE_CONTAINER(targets);
+    SERIALIZE_CONTAINER(tids);
+    SERIALIZE_CONTAINER(valid);
+}
+
+void
+BPredDriver::unserialize(CheckpointIn &cp)
+{
+    std::vector<uint64_t> tags;
+    std::vector<uint64_t> targets;
+    std::vector<unsigned> tids;
+    std::vector<unsigned> valid;
+    uint64_t branches;
+    UNSERIALIZE_SCALAR(branches);
+    UNSERIALIZE_CONTAINER(tags);
+    UNSERIALIZE_CONTAINER(targets);
+    UNSERIALIZE_CONTAINER(tids);
+    UNSERIALIZE_CONTAINER(valid);
+    fatal_if(tags.size() != btb.size() || targets.size() != btb.size() ||
+             tids.size() != btb.size() || valid.size() != btb.size(),
+             "Checkpointed BTB does not have %d entries.\n", btb.size());
+
+    for (size_t i = 0; i < btb.size(); i++) {
+        btb[i].tag = tags[i];
+        btb[i].target = targets[i];
+        btb[i].tid = tids[i];
+        btb[i].valid = valid[i];
+    }
+    position = branches;
+}
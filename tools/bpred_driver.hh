@@ -0,0 +1,204 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A minimal front end that drives a BPredUnit direction predictor from a
+ * recorded branch stream.
+ */
+
+#ifndef __TOOLS_BPRED_DRIVER_HH__
+#define __TOOLS_BPRED_DRIVER_HH__
+
+#include <cstdint>
+#include <vector>
+
+#include "base/types.hh"
+#include "branch_stream.hh"
+#include "cpu/pred/bpred_unit.hh"
+#include "sim/serialize.hh"
+
+/**
+ * Stands in for the parts of gem5's BPredUnit that sit around the
+ * direction predictor: the BTB, the misprediction squash and the commit
+ * time update. Each branch is predicted, resolved and committed before
+ * the next one is fetched, so the predictor sees exactly the call
+ * sequence an in-order gem5 CPU generates for a committed stream:
+ *
+ *  - lookup() or uncondBranch() at fetch,
+ *  - btbUpdate() when a taken prediction misses in the BTB,
+ *  - update(squashed=true) when the branch mispredicted,
+ *  - update(squashed=false) at commit.
+ *
+ * Wrong-path branches are not part of a committed stream, so squash()
+ * is never needed here.
+ *
+ * The driver checkpoints its BTB and counts next to the predictor so a
+ * restored replay continues exactly where the saved one stopped.
+ */
+class BPredDriver : public Serializable
+{
+  public:
+    struct Counts
+    {
+        uint64_t branches = 0;
+        uint64_t condPredicted = 0;
+        uint64_t uncondBranches = 0;
+        uint64_t btbLookups = 0;
+        uint64_t btbHits = 0;
+        /** Squashes; gem5 reports these as condIncorrect. */
+        uint64_t mispredicts = 0;
+        uint64_t condMispredicts = 0;
+        uint64_t insts = 0;
+    };
+
+    /**
+     * @param bp Direction predictor being driven.
+     * @param btb_entries BTB size, as BranchPredictor.BTBEntries.
+     * @param btb_tag_bits BTB tag width, as BranchPredictor.BTBTagSize.
+     * @param inst_shift_amt As BranchPredictor.instShiftAmt.
+     */
+    BPredDriver(BPredUnit &bp, unsigned btb_entries, unsigned btb_tag_bits,
+                unsigned inst_shift_amt);
+
+    /** Predict, resolve and commit one branch. */
+    void
+    replay(ThreadID tid, const BranchRecord &br)
+    {
+        void *bp_history = nullptr;
+        bool pred_taken;
+
+        position++;
+        counts.branches++;
+        counts.insts += br.instDelta;
+        if (br.conditional) {
+            counts.condPredicted++;
+            pred_taken = bp.lookup(tid, br.pc, bp_history);
+        } else {
+            counts.uncondBranches++;
+            bp.uncondBranch(tid, br.pc, bp_history);
+            pred_taken = true;
+        }
+
+        Addr pred_target = 0;
+        if (pred_taken) {
+            counts.btbLookups++;
+            const BTBEntry &entry = btb[btbIndex(br.pc)];
+            if (entry.valid && entry.tid == tid &&
+                    entry.tag == btbTag(br.pc)) {
+                counts.btbHits++;
+                pred_target = entry.target;
+            } else {
+                pred_taken = false;
+                bp.btbUpdate(tid, br.pc, bp_history);
+            }
+        }
+
+        if (pred_taken != br.taken ||
+                (br.taken && pred_target != br.target)) {
+            counts.mispredicts++;
+            if (br.conditional) {
+                counts.condMispredicts++;
+            }
+            bp.update(tid, br.pc, br.taken, bp_history, true, nullptr,
+                      br.target);
+            if (br.taken) {
+                BTBEntry &entry = btb[btbIndex(br.pc)];
+                entry.tid = tid;
+                entry.valid = true;
+                entry.tag = btbTag(br.pc);
+                entry.target = br.target;
+            }
+        }
+
+        bp.update(tid, br.pc, br.taken, bp_history, false, nullptr,
+                  br.target);
+    }
+
+    /**
+     * Functionally warm the BTB with a committed branch, as a fast
+     * forwarding CPU would alongside GSelectBP::warm(). Nothing is
+     * counted.
+     */
+    void
+    warmBTB(ThreadID tid, const BranchRecord &br)
+    {
+        position++;
+        if (br.taken) {
+            BTBEntry &entry = btb[btbIndex(br.pc)];
+            entry.tid = tid;
+            entry.valid = true;
+            entry.tag = btbTag(br.pc);
+            entry.target = br.target;
+        }
+    }
+
+    const Counts &getCounts() const { return counts; }
+
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
+
+    /**
+     * Number of branches consumed from the stream, including those
+     * before a restored checkpoint, i.e. where in the stream to resume.
+     */
+    uint64_t resumePoint() const { return position; }
+
+  private:
+    struct BTBEntry
+    {
+        Addr tag = 0;
+        Addr target = 0;
+        ThreadID tid = 0;
+        bool valid = false;
+    };
+
+    unsigned btbIndex(Addr pc) const
+    {
+        return (pc >> instShiftAmt) & btbIdxMask;
+    }
+
+    Addr btbTag(Addr pc) const
+    {
+        return (pc >> btbTagShiftAmt) & btbTagMask;
+    }
+
+    BPredUnit &bp;
+
+    std::vector<BTBEntry> btb;
+    const unsigned instShiftAmt;
+    unsigned btbIdxMask;
+    unsigned btbTagShiftAmt;
+    Addr btbTagMask;
+
+    Counts counts;
+    /** Branches consumed from the stream, replayed or warmed. */
+    uint64_t position = 0;
+};
+
+#endif // __TOOLS_BPRED_DRIVER_HH__
@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Loading of recorded branch streams.
+ */
+
+#include "branch_stream.hh"
+
+#include <cstdlib>
+#include <fstream>
+
+#include "branch_trace.hh"
+
+bool
+loadBranchStream(const std::string &path,
+                 std::vector<BranchRecord> &records, std::string &err)
+{
+    if (BranchTraceReader::isBranchTrace(path)) {
+        BranchTraceReader reader;
+        if (!reader.open(path, err)) {
+            return false;
+        }
+        records.reserve(records.size() + reader.size());
+        BranchTraceReader::Cursor cursor = reader.cursor();
+        BranchRecord br;
+        while (cursor.next(br)) {
+            records.push_back(br);
+        }
+        if (cursor.failed()) {
+            err = path + ": corrupt chunk";
+            return false;
+        }
+        return true;
+    }
+
+    std::ifstream in(path);
+    if (!in) {
+        err = "cannot open " + path;
+        return false;
+    }
+
+    std::string line;
+    unsigned long line_no = 0;
+    while (std::getline(in, line)) {
+        line_no++;
+        const char *p = line.c_str();
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '\0' || *p == '#') {
+            continue;
+        }
+
+        BranchRecord br;
+        char *end;
+        const char *field = p;
+        br.pc = std::strtoull(field, &end, 16);
+        bool ok = end != field;
+        field = end;
+        br.target = std::strtoull(field, &end, 16);
+        ok = ok && end != field;
+        field = end;
+        const unsigned long taken = std::strtoul(field, &end, 10);
+        ok = ok && end != field && taken <= 1;
+        field = end;
+        const unsigned long cond = std::strtoul(field, &end, 10);
+        ok = ok && end != field && cond <= 1;
+        if (!ok) {
+            err = path + ":" + std::to_string(line_no) +
+                ": expected '<pc> <target> <taken> <conditional>'";
+            return false;
+        }
+        field = end;
+        br.instDelta = std::strtoul(field, &end, 10);
+        br.taken = taken;
+        br.conditional = cond;
+        records.push_back(br);
+    }
+    return true;
+}
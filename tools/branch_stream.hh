@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Recorded branch streams for the standalone predictor tools.
+ */
+
+#ifndef __TOOLS_BRANCH_STREAM_HH__
+#define __TOOLS_BRANCH_STREAM_HH__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** One committed branch. */
+struct BranchRecord
+{
+    uint64_t pc;
+    uint64_t target;
+    /** Instructions committed since the previous branch, this one
+     * included. Zero when the trace does not say. */
+    uint32_t instDelta;
+    bool taken;
+    bool conditional;
+};
+
+/**
+ * Load a whole branch stream into memory so that replay never waits on
+ * parsing.
+ *
+ * Text traces hold one branch per line:
+ *
+ *     <pc> <target> <taken> <conditional> [<instructions>]
+ *
+ * with the addresses in hex and the flags as 0 or 1. Blank lines and
+ * lines starting with '#' are skipped. Binary traces (see
+ * branch_trace.hh) are recognised by their magic and decoded instead.
+ *
+ * @param path Trace file to read.
+ * @param records Filled with the decoded branches.
+ * @param err Set to a description of the problem on failure.
+ * @return Whether the trace was read successfully.
+ */
+bool loadBranchStream(const std::string &path,
+                      std::vector<BranchRecord> &records, std::string &err);
+
+#endif // __TOOLS_BRANCH_STREAM_HH__
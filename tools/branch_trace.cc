@@ -0,0 +1,304 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Writing and mapping binary branch traces.
+ */
+
+#include "branch_trace.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+namespace
+{
+
+const char Magic[8] = {'G', 'S', 'B', 'T', 'R', 'A', 'C', 'E'};
+const uint32_t Version = 1;
+
+uint64_t
+zigzag(uint64_t v)
+{
+    return (v << 1) ^ -(v >> 63);
+}
+
+void
+putVarint(std::vector<uint8_t> &out, uint64_t v)
+{
+    while (v >= 0x80) {
+        out.push_back(uint8_t(v) | 0x80);
+        v >>= 7;
+    }
+    out.push_back(v);
+}
+
+} // anonymous namespace
+
+BranchTraceWriter::BranchTraceWriter(uint32_t chunk_branches)
+    : chunkBranches(chunk_branches ? chunk_branches : 1), file(nullptr),
+      chunkCount(0), prevPc(0), branches(0), offset(0), writeFailed(false)
+{
+}
+
+BranchTraceWriter::~BranchTraceWriter()
+{
+    if (file) {
+        std::fclose(file);
+    }
+}
+
+bool
+BranchTraceWriter::open(const std::string &_path, std::string &err)
+{
+    path = _path;
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        err = "cannot create " + path;
+        return false;
+    }
+    // The header is rewritten with the totals on close().
+    BranchTraceHeader header = {};
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+        err = "cannot write " + path;
+        return false;
+    }
+    offset = sizeof(header);
+    writeFailed = false;
+    return true;
+}
+
+void
+BranchTraceWriter::append(const BranchRecord &br)
+{
+    if (chunkCount % 4 == 0) {
+        flags.push_back(0);
+    }
+    flags.back() |= (br.taken | br.conditional << 1) << (2 * (chunkCount % 4));
+    putVarint(varints, zigzag(br.pc - prevPc));
+    putVarint(varints, zigzag(br.target - br.pc));
+    putVarint(varints, br.instDelta);
+    prevPc = br.pc;
+    branches++;
+    if (++chunkCount == chunkBranches) {
+        flushChunk();
+    }
+}
+
+void
+BranchTraceWriter::flushChunk()
+{
+    if (!chunkCount) {
+        return;
+    }
+    BranchTraceChunk chunk;
+    chunk.offset = offset;
+    chunk.bytes = flags.size() + varints.size();
+    chunk.branches = chunkCount;
+    index.push_back(chunk);
+
+    if (std::fwrite(flags.data(), 1, flags.size(), file) != flags.size() ||
+            std::fwrite(varints.data(), 1, varints.size(), file) !=
+            varints.size()) {
+        writeFailed = true;
+    }
+    offset += chunk.bytes;
+
+    flags.clear();
+    varints.clear();
+    chunkCount = 0;
+    prevPc = 0;
+}
+
+bool
+BranchTraceWriter::close(std::string &err)
+{
+    flushChunk();
+
+    // Chunks are byte streams of any length; pad so the index that
+    // follows them can be used in place from the mapping.
+    static const uint8_t zeros[alignof(BranchTraceChunk)] = {};
+    const size_t pad = (alignof(BranchTraceChunk) -
+                        offset % alignof(BranchTraceChunk)) %
+        alignof(BranchTraceChunk);
+    if (std::fwrite(zeros, 1, pad, file) != pad) {
+        writeFailed = true;
+    }
+    offset += pad;
+
+    BranchTraceHeader header;
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.chunkBranches = chunkBranches;
+    header.branches = branches;
+    header.chunks = index.size();
+    header.indexOffset = offset;
+
+    const bool ok = !writeFailed &&
+        std::fwrite(index.data(), sizeof(BranchTraceChunk), index.size(),
+                    file) == index.size() &&
+        std::fseek(file, 0, SEEK_SET) == 0 &&
+        std::fwrite(&header, sizeof(header), 1, file) == 1;
+    const bool closed = std::fclose(file) == 0;
+    file = nullptr;
+    if (!ok || !closed) {
+        err = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+BranchTraceReader::~BranchTraceReader()
+{
+    if (data) {
+        munmap(const_cast<uint8_t *>(data), length);
+    }
+}
+
+bool
+BranchTraceReader::isBranchTrace(const std::string &path)
+{
+    char magic[sizeof(Magic)];
+    FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    const bool match = std::fread(magic, sizeof(magic), 1, file) == 1 &&
+        std::memcmp(magic, Magic, sizeof(Magic)) == 0;
+    std::fclose(file);
+    return match;
+}
+
+bool
+BranchTraceReader::open(const std::string &path, std::string &err)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        err = "cannot open " + path;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(BranchTraceHeader)) {
+        ::close(fd);
+        err = path + " is not a binary branch trace";
+        return false;
+    }
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        err = "cannot map " + path;
+        return false;
+    }
+    data = static_cast<const uint8_t *>(map);
+    length = st.st_size;
+    madvise(map, length, MADV_SEQUENTIAL);
+
+    header = reinterpret_cast<const BranchTraceHeader *>(data);
+    if (std::memcmp(header->magic, Magic, sizeof(Magic)) != 0 ||
+            header->version != Version) {
+        err = path + " is not a version " + std::to_string(Version) +
+            " binary branch trace";
+        header = nullptr;
+        return false;
+    }
+
+    const uint64_t index_bytes = header->chunks * sizeof(BranchTraceChunk);
+    if (header->indexOffset < sizeof(BranchTraceHeader) ||
+            header->indexOffset > length ||
+            header->chunks > length / sizeof(BranchTraceChunk) ||
+            length - header->indexOffset != index_bytes ||
+            header->indexOffset % alignof(BranchTraceChunk) != 0) {
+        err = path + ": bad chunk index";
+        header = nullptr;
+        return false;
+    }
+    index = reinterpret_cast<const BranchTraceChunk *>(
+        data + header->indexOffset);
+
+    // Every chunk but the last is full, so chunkStart() can find
+    // branches without searching.
+    uint64_t total = 0;
+    for (uint64_t c = 0; c < header->chunks; c++) {
+        const BranchTraceChunk &chunk = index[c];
+        const bool last = c + 1 == header->chunks;
+        if (chunk.offset < sizeof(BranchTraceHeader) ||
+                chunk.offset + chunk.bytes > header->indexOffset ||
+                !chunk.branches || chunk.branches > header->chunkBranches ||
+                (!last && chunk.branches != header->chunkBranches) ||
+                chunk.bytes < (chunk.branches + 3) / 4) {
+            err = path + ": bad chunk " + std::to_string(c);
+            header = nullptr;
+            return false;
+        }
+        total += chunk.branches;
+    }
+    if (total != header->branches) {
+        err = path + ": chunk index does not add up";
+        header = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool
+BranchTraceReader::Cursor::enterChunk(uint64_t c)
+{
+    if (!reader.header || c >= reader.header->chunks) {
+        return false;
+    }
+    const BranchTraceChunk &info = reader.index[c];
+    chunk = c;
+    flagBytes = reader.data + info.offset;
+    ptr = flagBytes + (info.branches + 3) / 4;
+    end = flagBytes + info.bytes;
+    idx = 0;
+    count = info.branches;
+    pc = 0;
+    return true;
+}
+
+BranchTraceReader::Cursor
+BranchTraceReader::cursor(uint64_t first) const
+{
+    Cursor cur(*this);
+    if (!header || first >= header->branches) {
+        // Positioned past the last chunk: next() reports the end.
+        cur.chunk = header ? header->chunks : 0;
+        return cur;
+    }
+    cur.enterChunk(first / header->chunkBranches);
+    BranchRecord skipped;
+    for (uint64_t i = chunkStart(cur.chunk); i < first; i++) {
+        cur.next(skipped);
+    }
+    return cur;
+}
@@ -0,0 +1,232 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A compact, seekable binary format for recorded branch streams.
+ *
+ * Layout, little-endian:
+ *
+ *  - BranchTraceHeader.
+ *  - Chunks of chunkBranches branches each (the last may be shorter).
+ *    A chunk is a bitstream of 2 bits per branch (bit 0 taken, bit 1
+ *    conditional), padded to a byte, followed by three LEB128 varints
+ *    per branch: the zigzagged PC delta from the previous branch of the
+ *    chunk (from 0 for the first), the zigzagged target offset from the
+ *    PC and the instruction delta. Chunks share no state, so any of
+ *    them decodes on its own.
+ *  - Zero padding up to an 8-byte boundary.
+ *  - The chunk index at header.indexOffset: one BranchTraceChunk each.
+ */
+
+#ifndef __TOOLS_BRANCH_TRACE_HH__
+#define __TOOLS_BRANCH_TRACE_HH__
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "branch_stream.hh"
+
+struct BranchTraceHeader
+{
+    /** "GSBTRACE". */
+    char magic[8];
+    uint32_t version;
+    uint32_t chunkBranches;
+    uint64_t branches;
+    uint64_t chunks;
+    uint64_t indexOffset;
+};
+
+struct BranchTraceChunk
+{
+    uint64_t offset;
+    uint32_t bytes;
+    uint32_t branches;
+};
+
+static_assert(sizeof(BranchTraceHeader) == 40, "unexpected padding");
+static_assert(sizeof(BranchTraceChunk) == 16, "unexpected padding");
+
+/** Writes a binary branch trace one branch at a time. */
+class BranchTraceWriter
+{
+  public:
+    /** @param chunk_branches Branches per chunk. */
+    explicit BranchTraceWriter(uint32_t chunk_branches = 65536);
+    ~BranchTraceWriter();
+
+    BranchTraceWriter(const BranchTraceWriter &) = delete;
+    BranchTraceWriter &operator=(const BranchTraceWriter &) = delete;
+
+    bool open(const std::string &path, std::string &err);
+
+    void append(const BranchRecord &br);
+
+    /** Write the last chunk and the index. */
+    bool close(std::string &err);
+
+  private:
+    void flushChunk();
+
+    const uint32_t chunkBranches;
+    FILE *file;
+    std::string path;
+
+    std::vector<uint8_t> flags;
+    std::vector<uint8_t> varints;
+    uint32_t chunkCount;
+    uint64_t prevPc;
+
+    uint64_t branches;
+    uint64_t offset;
+    std::vector<BranchTraceChunk> index;
+    /** A chunk could not be written; close() reports it. */
+    bool writeFailed;
+};
+
+/**
+ * Reads a binary branch trace in place from a read-only mapping; branches
+ * are decoded straight from the mapped chunks, never copied in bulk.
+ */
+class BranchTraceReader
+{
+  public:
+    BranchTraceReader() = default;
+    ~BranchTraceReader();
+
+    BranchTraceReader(const BranchTraceReader &) = delete;
+    BranchTraceReader &operator=(const BranchTraceReader &) = delete;
+
+    /** Whether a file starts with the binary trace magic. */
+    static bool isBranchTrace(const std::string &path);
+
+    /** Map a trace and check its header and index. */
+    bool open(const std::string &path, std::string &err);
+
+    uint64_t size() const { return header ? header->branches : 0; }
+    uint64_t numChunks() const { return header ? header->chunks : 0; }
+
+    /** Index of the first branch of a chunk. */
+    uint64_t
+    chunkStart(uint64_t chunk) const
+    {
+        return chunk * header->chunkBranches;
+    }
+
+    /** Sequential decoder positioned anywhere in the trace. */
+    class Cursor
+    {
+      public:
+        /**
+         * Decode the next branch.
+         *
+         * @return false at the end of the trace or on a corrupt chunk,
+         * which failed() then tells apart.
+         */
+        bool
+        next(BranchRecord &br)
+        {
+            if (idx == count && !enterChunk(chunk + 1)) {
+                return false;
+            }
+            const unsigned bits = flagBytes[idx >> 2] >> (2 * (idx & 3));
+            uint64_t pc_delta, target_delta, insts;
+            if (!readVarint(pc_delta) || !readVarint(target_delta) ||
+                    !readVarint(insts)) {
+                corrupt = true;
+                return false;
+            }
+            pc += unzigzag(pc_delta);
+            br.pc = pc;
+            br.target = pc + unzigzag(target_delta);
+            br.instDelta = insts;
+            br.taken = bits & 1;
+            br.conditional = bits & 2;
+            idx++;
+            return true;
+        }
+
+        bool failed() const { return corrupt; }
+
+      private:
+        friend class BranchTraceReader;
+
+        explicit Cursor(const BranchTraceReader &reader)
+            : reader(reader)
+        {}
+
+        bool enterChunk(uint64_t chunk);
+
+        static uint64_t
+        unzigzag(uint64_t v)
+        {
+            return (v >> 1) ^ -(v & 1);
+        }
+
+        bool
+        readVarint(uint64_t &v)
+        {
+            v = 0;
+            for (unsigned shift = 0; ptr != end && shift < 64; shift += 7) {
+                const uint8_t byte = *ptr++;
+                v |= uint64_t(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        const BranchTraceReader &reader;
+        uint64_t chunk = 0;
+        const uint8_t *flagBytes = nullptr;
+        const uint8_t *ptr = nullptr;
+        const uint8_t *end = nullptr;
+        uint32_t idx = 0;
+        uint32_t count = 0;
+        uint64_t pc = 0;
+        bool corrupt = false;
+    };
+
+    /**
+     * A cursor at branch first; chunks are found through the index so
+     * this only decodes from the start of first's chunk.
+     */
+    Cursor cursor(uint64_t first = 0) const;
+
+  private:
+    const uint8_t *data = nullptr;
+    size_t length = 0;
+    const BranchTraceHeader *header = nullptr;
+    const BranchTraceChunk *index = nullptr;
+};
+
+#endif // __TOOLS_BRANCH_TRACE_HH__
@@ -0,0 +1,212 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Conversion between text and binary branch traces:
+ *
+ *     branch_trace_convert [--chunk N] <in> <out.bin>
+ *     branch_trace_convert --text <in> <out.txt>
+ *     branch_trace_convert --self-test
+ *
+ * The input may be in either format. A binary trace is read back and
+ * compared with the input after it is written. --self-test round-trips
+ * a random stream through a range of chunk sizes.
+ */
+
+#include <getopt.h>
+#include <unistd.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "branch_stream.hh"
+#include "branch_trace.hh"
+
+namespace
+{
+
+void
+usage(const char *prog)
+{
+    std::fprintf(stderr,
+        "usage: %s [options] <in> <out>\n"
+        "  --chunk N         branches per chunk (default 65536)\n"
+        "  --text            write a text trace instead\n"
+        "  --self-test       round-trip a random stream through several\n"
+        "                    chunk sizes\n",
+        prog);
+}
+
+/** Write records as a binary trace, then map it and compare. */
+bool
+writeAndVerify(const std::vector<BranchRecord> &records,
+               const std::string &path, uint32_t chunk, std::string &err)
+{
+    BranchTraceWriter writer(chunk);
+    if (!writer.open(path, err)) {
+        return false;
+    }
+    for (const BranchRecord &br : records) {
+        writer.append(br);
+    }
+    if (!writer.close(err)) {
+        return false;
+    }
+
+    BranchTraceReader reader;
+    if (!reader.open(path, err)) {
+        return false;
+    }
+    if (reader.size() != records.size()) {
+        err = path + ": read back " + std::to_string(reader.size()) +
+            " branches, wrote " + std::to_string(records.size());
+        return false;
+    }
+    BranchTraceReader::Cursor cursor = reader.cursor(0);
+    BranchRecord br;
+    for (size_t i = 0; i < records.size(); i++) {
+        const BranchRecord &want = records[i];
+        if (!cursor.next(br) || br.pc != want.pc ||
+                br.target != want.target || br.taken != want.taken ||
+                br.conditional != want.conditional ||
+                br.instDelta != want.instDelta) {
+            err = path + ": branch " + std::to_string(i) +
+                " does not read back as written";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Round-trip a random stream, with forward and backward PC deltas and
+ * targets across the whole address space, through chunk sizes that
+ * leave the chunk data at every alignment.
+ */
+int
+selfTest()
+{
+    std::mt19937_64 rng(1);
+    std::vector<BranchRecord> records(100000);
+    uint64_t pc = 0x400000;
+    for (BranchRecord &br : records) {
+        const uint64_t r = rng();
+        pc = r % 16 ? pc + 4 * (r >> 60) : rng();
+        br.pc = pc;
+        br.target = r % 5 ? pc + int64_t(rng() % 4096) - 2048 : rng();
+        br.taken = r >> 63;
+        br.conditional = (r >> 62) & 1;
+        br.instDelta = r % 7 ? (r >> 8) % 64 : uint32_t(rng());
+    }
+
+    const char *tmpdir = std::getenv("TMPDIR");
+    std::string path = std::string(tmpdir ? tmpdir : "/tmp") +
+        "/branch_trace_selftest." + std::to_string(getpid());
+    static const uint32_t chunks[] =
+        {1, 2, 3, 7, 13, 100, 1000, 4096, 65536, 1000000};
+    int failures = 0;
+    for (uint32_t chunk : chunks) {
+        std::string err;
+        if (!writeAndVerify(records, path, chunk, err)) {
+            std::fprintf(stderr, "chunk %u: %s\n", chunk, err.c_str());
+            failures++;
+        }
+    }
+    unlink(path.c_str());
+    std::printf("branch trace round trip: %s\n", failures ? "FAIL" : "ok");
+    return failures ? 1 : 0;
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char **argv)
+{
+    unsigned long chunk = 65536;
+    bool text = false;
+
+    static const struct option long_opts[] = {
+        {"chunk", required_argument, nullptr, 'c'},
+        {"text", no_argument, nullptr, 't'},
+        {"self-test", no_argument, nullptr, 's'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "h", long_opts, nullptr)) != -1) {
+        switch (c) {
+          case 'c': chunk = std::strtoul(optarg, nullptr, 0); break;
+          case 't': text = true; break;
+          case 's': return selfTest();
+          default:
+            usage(argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    if (optind != argc - 2 || !chunk || chunk > UINT32_MAX) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<BranchRecord> records;
+    std::string err;
+    if (!loadBranchStream(argv[optind], records, err)) {
+        std::fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+
+    const char *out_path = argv[optind + 1];
+    if (text) {
+        FILE *out = std::fopen(out_path, "w");
+        if (!out) {
+            std::fprintf(stderr, "cannot create %s\n", out_path);
+            return 1;
+        }
+        for (const BranchRecord &br : records) {
+            std::fprintf(out, "%" PRIx64 " %" PRIx64 " %d %d %u\n", br.pc,
+                         br.target, br.taken, br.conditional, br.instDelta);
+        }
+        if (std::fclose(out) != 0) {
+            std::fprintf(stderr, "cannot write %s\n", out_path);
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!writeAndVerify(records, out_path, chunk, err)) {
+        std::fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A minimal set-associative cache that drives a gem5 replacement policy
+ * from an address stream.
+ */
+
+#include "cache_model.hh"
+
+#include <random>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+CacheModel::CacheModel(ReplacementPolicy::Base &rp, unsigned num_sets,
+                       unsigned assoc, unsigned block_size)
+    : rp(rp), assoc(assoc), blocks(num_sets * assoc), sets(num_sets)
+{
+    fatal_if(!isPowerOf2(num_sets), "Number of sets is not a power of 2.\n");
+    fatal_if(!isPowerOf2(block_size), "Block size is not a power of 2.\n");
+    blockShift = floorLog2(block_size);
+    setShift = floorLog2(num_sets);
+    setMask = num_sets - 1;
+
+    for (unsigned idx = 0; idx < blocks.size(); idx++) {
+        Block &blk = blocks[idx];
+        blk.setPosition(idx / assoc, idx % assoc);
+        blk.replacementData = rp.instantiateEntry();
+        sets[idx / assoc].push_back(&blk);
+    }
+}
+
+uint64_t
+CacheModel::checkVictims(uint64_t lists, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    const unsigned num_sets = sets.size();
+    ReplacementCandidates probe(assoc + 1);
+    auto at_lru = [&](ReplaceableEntry *blk) {
+        std::fill(probe.begin(), probe.end() - 1,
+                  &blocks[blk == &blocks[0] ? 1 : 0]);
+        probe.back() = blk;
+        return rp.getVictim(probe) == blk;
+    };
+
+    uint64_t failures = 0;
+    ReplacementCandidates candidates(assoc);
+    for (uint64_t list = 0; list < lists; list++) {
+        const unsigned first_set = rng() % num_sets;
+        const unsigned kind = list % 3;
+        for (unsigned way = 0; way < assoc; way++) {
+            unsigned set = first_set;
+            if (kind == 1 && rng() % 2) {
+                set = rng() % num_sets;
+            }
+            candidates[way] = kind == 2 ? &blocks[rng() % blocks.size()] :
+                &blocks[set * assoc + way];
+        }
+
+        ReplaceableEntry *want = candidates[0];
+        for (ReplaceableEntry *blk : candidates) {
+            if (at_lru(blk)) {
+                want = blk;
+            }
+        }
+        failures += rp.getVictim(candidates) != want;
+    }
+    return failures;
+}
@@ -0,0 +1,147 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A minimal set-associative cache that drives a gem5 replacement policy
+ * from an address stream.
+ */
+
+#ifndef __TOOLS_CACHE_MODEL_HH__
+#define __TOOLS_CACHE_MODEL_HH__
+
+#include <cstdint>
+#include <vector>
+
+#include "base/types.hh"
+#include "mem/cache/replacement_policies/base.hh"
+
+/**
+ * Stands in for gem5's BaseSetAssoc tags with a SetAssociative indexing
+ * policy. Blocks are created set-major and given their replacement data
+ * in that order, and the policy sees the same calls the tags make:
+ *
+ *  - touch() on a hit,
+ *  - getVictim() over all ways of the set on a miss,
+ *  - invalidate() when the victim holds a valid block,
+ *  - reset() when the new block is inserted.
+ */
+class CacheModel
+{
+  public:
+    struct Counts
+    {
+        uint64_t accesses = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        /** Order-sensitive hash of the chosen victims, for comparing
+         * policy implementations. */
+        uint64_t victimHash = 0;
+    };
+
+    /**
+     * @param rp Replacement policy, not yet used by any other cache.
+     * @param num_sets Number of sets, a power of 2.
+     * @param assoc Ways per set.
+     * @param block_size Block size in bytes, a power of 2.
+     */
+    CacheModel(ReplacementPolicy::Base &rp, unsigned num_sets,
+               unsigned assoc, unsigned block_size);
+
+    /** Look up addr, filling it on a miss. @return Whether it hit. */
+    bool
+    access(Addr addr)
+    {
+        counts.accesses++;
+        const Addr blk_addr = addr >> blockShift;
+        const unsigned set = blk_addr & setMask;
+        const Addr tag = blk_addr >> setShift;
+
+        Block *ways = &blocks[set * assoc];
+        for (unsigned way = 0; way < assoc; way++) {
+            if (ways[way].valid && ways[way].tag == tag) {
+                counts.hits++;
+                rp.touch(ways[way].replacementData);
+                return true;
+            }
+        }
+
+        counts.misses++;
+        Block *victim = static_cast<Block *>(rp.getVictim(sets[set]));
+        counts.victimHash = (counts.victimHash ^ victim->getWay()) *
+            ULL(0x100000001b3);
+        if (victim->valid) {
+            counts.evictions++;
+            rp.invalidate(victim->replacementData);
+        }
+        victim->valid = true;
+        victim->tag = tag;
+        rp.reset(victim->replacementData);
+        return false;
+    }
+
+    const Counts &getCounts() const { return counts; }
+
+    /**
+     * Check getVictim() on candidate lists other indexing policies hand
+     * over, against its documented rule: the last candidate at the LRU
+     * position, or the first if none is. Lists are a set in way order,
+     * one way from each of several sets as a skewed policy gives, often
+     * with several from the first set, and random blocks. Whether a
+     * block is at the LRU position is asked of getVictim() itself, with
+     * the block after a run of another block, which no fast path for a
+     * whole set can take. The policy's state is left unchanged.
+     *
+     * @param lists Candidate lists to check.
+     * @param seed Seed of the random lists.
+     * @return Lists whose victim broke the rule.
+     */
+    uint64_t checkVictims(uint64_t lists, uint64_t seed);
+
+  private:
+    struct Block : public ReplaceableEntry
+    {
+        Addr tag = 0;
+        bool valid = false;
+    };
+
+    ReplacementPolicy::Base &rp;
+    const unsigned assoc;
+    unsigned blockShift;
+    unsigned setShift;
+    unsigned setMask;
+
+    std::vector<Block> blocks;
+    /** Candidate list of each set, as the indexing policy keeps it. */
+    std::vector<ReplacementCandidates> sets;
+
+    Counts counts;
+};
+
+#endif // __TOOLS_CACHE_MODEL_HH__
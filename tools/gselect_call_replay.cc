@@ -0,0 +1,278 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Offline replay of a GSelectBP call log (GSelectBP.callLog, or
+ * gselect_replay --call-log):
+ *
+ *     gselect_call_replay [options] <gselect.calllog>
+ *
+ * A predictor with the recorded geometry is fed the logged calls in
+ * order, wrong-path lookups and squashes included, and its predictions
+ * and final state digest are checked against the ones recorded. The
+ * exit status is 0 only if everything matched.
+ */
+
+#include <getopt.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cpu/pred/bp_call_log.hh"
+#include "cpu/pred/gselect.hh"
+#include "sim/serialize.hh"
+
+namespace
+{
+
+void
+usage(const char *prog)
+{
+    std::fprintf(stderr,
+        "usage: %s [options] <calllog>\n"
+        "  --packed          replay with packedPHT, unless the log is of a\n"
+        "                    tagged PHT\n"
+        "  --no-kernels      replay with specializedKernels=False\n"
+        "  --restore DIR     restore the predictor from the checkpoint the\n"
+        "                    recorded run started from\n"
+        "  --print           print the calls instead of replaying them\n",
+        prog);
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char **argv)
+{
+    GSelectBPParams params;
+    params.name = "gselect";
+    std::string restore_dir;
+    bool print = false;
+
+    static const struct option long_opts[] = {
+        {"packed", no_argument, nullptr, 'P'},
+        {"no-kernels", no_argument, nullptr, 'K'},
+        {"restore", required_argument, nullptr, 'R'},
+        {"print", no_argument, nullptr, 'p'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "h", long_opts, nullptr)) != -1) {
+        switch (c) {
+          case 'P': params.packedPHT = true; break;
+          case 'K': params.specializedKernels = false; break;
+          case 'R': restore_dir = optarg; break;
+          case 'p': print = true; break;
+          default:
+            usage(argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE *file = std::fopen(argv[optind], "rb");
+    if (!file) {
+        std::fprintf(stderr, "cannot open %s\n", argv[optind]);
+        return 1;
+    }
+
+    BPCallLogHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+        std::memcmp(header.magic, BPCallLogMagic, sizeof(header.magic)) ||
+        header.version != BPCallLogVersion) {
+        std::fprintf(stderr, "%s is not a GSelectBP call log (version %u)\n",
+                     argv[optind], BPCallLogVersion);
+        return 1;
+    }
+    if (header.indexFunction >= Enums::Num_GSelectIndexFunction) {
+        std::fprintf(stderr, "%s: unknown index function %u\n",
+                     argv[optind], header.indexFunction);
+        return 1;
+    }
+    params.numThreads = header.numThreads;
+    params.PredictorSize = header.predictorSize;
+    params.PHTCtrBits = header.phtCtrBits;
+    params.globalHistoryBits = header.globalHistoryBits;
+    params.foldedHistoryBits = header.foldedHistoryBits;
+    params.indexFunction =
+        static_cast<Enums::GSelectIndexFunction>(header.indexFunction);
+    params.instShiftAmt = header.instShiftAmt;
+    params.threadHashedIndex = header.threadHashedIndex;
+    params.taggedWays = header.taggedWays;
+    if (header.taggedWays) {
+        params.packedPHT = false;
+        params.tagBits = header.tagBits;
+        params.bimodalSize = header.bimodalSize;
+    }
+
+    GSelectBP bp(params);
+    if (!restore_dir.empty()) {
+        CheckpointIn cp(restore_dir);
+        bp.unserializeSection(cp, params.name);
+    }
+    bp.startup();
+    if (!print && bp.stateDigest() != header.startDigest) {
+        std::fprintf(stderr, "%s: the recorded run started from a different "
+                     "predictor state%s\n", argv[optind],
+                     restore_dir.empty() ? "; pass its checkpoint with "
+                     "--restore" : "");
+        return 1;
+    }
+
+    // History records of the replay, by recorded sequence number.
+    std::unordered_map<uint32_t, void *> histories;
+    std::vector<unsigned long long> op_counts(NumBPCallOps);
+    unsigned long long calls = 0;
+    unsigned long long diverged = 0;
+    bool ended = false;
+    bool bad = false;
+    uint64_t final_digest = 0;
+
+    std::vector<BPCallRecord> records(1 << 16);
+    size_t count;
+    while (!ended && !bad &&
+           (count = std::fread(records.data(), sizeof(BPCallRecord),
+                               records.size(), file)) > 0) {
+        for (size_t i = 0; i < count && !ended && !bad; i++) {
+            const BPCallRecord &rec = records[i];
+            const ThreadID tid = rec.tid;
+            const bool taken = rec.flags & BPCallTaken;
+            calls++;
+            if (rec.op < NumBPCallOps) {
+                op_counts[rec.op]++;
+            }
+            if (print) {
+                std::printf("%-12s tid %u pc %#llx history %u%s%s%s\n",
+                            bpCallOpName(rec.op), rec.tid,
+                            (unsigned long long)rec.pc, rec.history,
+                            taken ? " taken" : "",
+                            rec.flags & BPCallSquashed ? " squashed" : "",
+                            rec.flags & BPCallConditional ?
+                                " conditional" : "");
+                ended = rec.op == BPCallEnd;
+                continue;
+            }
+            if (rec.op != BPCallEnd && tid >= (ThreadID)header.numThreads) {
+                std::fprintf(stderr, "call %llu: bad thread %u\n", calls,
+                             rec.tid);
+                bad = true;
+                break;
+            }
+
+            void *bp_history = nullptr;
+            if (rec.op == BPCallBTBUpdate || rec.op == BPCallUpdate ||
+                    rec.op == BPCallSquash) {
+                auto it = histories.find(rec.history);
+                if (it == histories.end()) {
+                    std::fprintf(stderr, "call %llu: %s of unknown history "
+                                 "%u\n", calls, bpCallOpName(rec.op),
+                                 rec.history);
+                    bad = true;
+                    break;
+                }
+                bp_history = it->second;
+            }
+
+            switch (rec.op) {
+              case BPCallLookup:
+                if (bp.lookup(tid, rec.pc, bp_history) != taken) {
+                    diverged++;
+                }
+                histories[rec.history] = bp_history;
+                break;
+              case BPCallUncondBranch:
+                bp.uncondBranch(tid, rec.pc, bp_history);
+                histories[rec.history] = bp_history;
+                break;
+              case BPCallBTBUpdate:
+                bp.btbUpdate(tid, rec.pc, bp_history);
+                break;
+              case BPCallUpdate: {
+                const bool squashed = rec.flags & BPCallSquashed;
+                bp.update(tid, rec.pc, taken, bp_history, squashed, nullptr,
+                          0);
+                if (!squashed) {
+                    histories.erase(rec.history);
+                }
+                break;
+              }
+              case BPCallSquash:
+                bp.squash(tid, bp_history);
+                histories.erase(rec.history);
+                break;
+              case BPCallWarm:
+                bp.warm(tid, rec.pc, rec.flags & BPCallConditional, taken);
+                break;
+              case BPCallEnd:
+                final_digest = rec.pc;
+                ended = true;
+                break;
+              default:
+                std::fprintf(stderr, "call %llu: unknown operation %u\n",
+                             calls, rec.op);
+                bad = true;
+                break;
+            }
+        }
+    }
+    std::fclose(file);
+
+    if (print) {
+        return 0;
+    }
+
+    std::printf("calls             %llu\n", calls);
+    for (unsigned op = 0; op < NumBPCallOps; op++) {
+        std::printf("%-17s %llu\n", bpCallOpName(op), op_counts[op]);
+    }
+    std::printf("inFlight          %zu\n", histories.size());
+    std::printf("predictionsDiffer %llu\n", diverged);
+    if (bad) {
+        return 1;
+    }
+    if (!ended) {
+        std::fprintf(stderr, "%s is truncated: no end record\n",
+                     argv[optind]);
+        return 1;
+    }
+    const uint64_t digest = bp.stateDigest();
+    std::printf("stateDigest       %016llx (recorded %016llx)\n",
+                (unsigned long long)digest,
+                (unsigned long long)final_digest);
+    return diverged || digest != final_digest ? 1 : 0;
+}
@@ -0,0 +1,344 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Standalone trace-driven replay of GSelectBP.
+ *
+ * The predictor sources are compiled unchanged against a small shim of
+ * the gem5 headers they use and driven by BPredDriver, so a recorded
+ * branch stream can be run through lookup()/update() at native speed:
+ *
+ *     gselect_replay [options] <trace>
+ *
+ * Options mirror the GSelectBP and BranchPredictor parameters; run with
+ * --help for the list. Binary traces (see branch_trace.hh) are decoded
+ * from their mapping as the replay goes instead of being loaded first.
+ */
+
+#include <getopt.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+#include <cerrno>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base/output.hh"
+#include "bpred_driver.hh"
+#include "branch_stream.hh"
+#include "branch_trace.hh"
+#include "cpu/pred/gselect.hh"
+#include "sim/core.hh"
+#include "sim/serialize.hh"
+
+namespace
+{
+
+void
+usage(const char *prog)
+{
+    std::fprintf(stderr,
+        "usage: %s [options] <trace>\n"
+        "  --size N          PredictorSize (default 1024)\n"
+        "  --ctr-bits N      PHTCtrBits (default 2)\n"
+        "  --hist-bits N     globalHistoryBits (default 8)\n"
+        "  --folded-bits N   foldedHistoryBits (default 0)\n"
+        "  --pool-size N     historyPoolSize (default 256)\n"
+        "  --index NAME      indexFunction: Concat, Gshare, Skewed or\n"
+        "                    Multiplicative (default Concat)\n"
+        "  --packed          packedPHT\n"
+        "  --tagged-ways N   taggedWays (default 0, direct-mapped PHT)\n"
+        "  --tag-bits N      tagBits (default 8)\n"
+        "  --bimodal-size N  bimodalSize (default 1024)\n"
+        "  --no-kernels      specializedKernels=False\n"
+        "  --btb-entries N   BTBEntries (default 4096)\n"
+        "  --btb-tag-bits N  BTBTagSize (default 16)\n"
+        "  --inst-shift N    instShiftAmt (default 2)\n"
+        "  --profile N       profileEntries (default 0, disabled)\n"
+        "  --profile-top N   profileTopN (default 64)\n"
+        "  --profile-format F  profileFormat, csv or json (default csv)\n"
+        "  --outdir DIR      where output files go (default .)\n"
+        "  --stats           dump the predictor's stats after the run\n"
+        "  --call-log        record the predictor calls to\n"
+        "                    <outdir>/gselect.calllog (callLog)\n"
+        "  --checkpoint-at N  stop after N branches and checkpoint the\n"
+        "                    predictor and BTB\n"
+        "  --checkpoint-dir DIR  where --checkpoint-at writes (default cpt)\n"
+        "  --restore DIR     resume from a checkpoint taken with the same\n"
+        "                    parameters and trace\n"
+        "  --warm N          functionally warm the predictor and BTB with\n"
+        "                    the first N branches, then replay the rest\n",
+        prog);
+}
+
+unsigned
+parseUnsigned(const char *opt, const char *arg)
+{
+    char *end;
+    const unsigned long v = std::strtoul(arg, &end, 0);
+    if (*arg == '\0' || *end != '\0') {
+        std::fprintf(stderr, "invalid value '%s' for --%s\n", arg, opt);
+        std::exit(1);
+    }
+    return v;
+}
+
+Enums::GSelectIndexFunction
+parseIndexFunction(const char *arg)
+{
+    for (int i = 0; i < Enums::Num_GSelectIndexFunction; i++) {
+        if (strcasecmp(arg, Enums::GSelectIndexFunctionStrings[i]) == 0) {
+            return static_cast<Enums::GSelectIndexFunction>(i);
+        }
+    }
+    std::fprintf(stderr, "unknown index function '%s'\n", arg);
+    std::exit(1);
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char **argv)
+{
+    GSelectBPParams params;
+    params.name = "gselect";
+    bool dump_stats = false;
+    uint64_t checkpoint_at = 0;
+    std::string checkpoint_dir = "cpt";
+    std::string restore_dir;
+    uint64_t warm_branches = 0;
+
+    static const struct option long_opts[] = {
+        {"size", required_argument, nullptr, 's'},
+        {"ctr-bits", required_argument, nullptr, 'c'},
+        {"hist-bits", required_argument, nullptr, 'g'},
+        {"folded-bits", required_argument, nullptr, 'f'},
+        {"pool-size", required_argument, nullptr, 'p'},
+        {"index", required_argument, nullptr, 'x'},
+        {"packed", no_argument, nullptr, 'P'},
+        {"tagged-ways", required_argument, nullptr, 'T'},
+        {"tag-bits", required_argument, nullptr, 'a'},
+        {"bimodal-size", required_argument, nullptr, 'm'},
+        {"no-kernels", no_argument, nullptr, 'K'},
+        {"btb-entries", required_argument, nullptr, 'b'},
+        {"btb-tag-bits", required_argument, nullptr, 't'},
+        {"inst-shift", required_argument, nullptr, 'i'},
+        {"profile", required_argument, nullptr, 'r'},
+        {"profile-top", required_argument, nullptr, 'n'},
+        {"profile-format", required_argument, nullptr, 'F'},
+        {"outdir", required_argument, nullptr, 'o'},
+        {"stats", no_argument, nullptr, 'S'},
+        {"call-log", no_argument, nullptr, 'L'},
+        {"checkpoint-at", required_argument, nullptr, 'C'},
+        {"checkpoint-dir", required_argument, nullptr, 'D'},
+        {"restore", required_argument, nullptr, 'R'},
+        {"warm", required_argument, nullptr, 'W'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    int opt_idx;
+    while ((c = getopt_long(argc, argv, "h", long_opts, &opt_idx)) != -1) {
+        const char *name = c == '?' || c == 'h' ? "" :
+            long_opts[opt_idx].name;
+        switch (c) {
+          case 's': params.PredictorSize = parseUnsigned(name, optarg); break;
+          case 'c': params.PHTCtrBits = parseUnsigned(name, optarg); break;
+          case 'g':
+            params.globalHistoryBits = parseUnsigned(name, optarg);
+            break;
+          case 'f':
+            params.foldedHistoryBits = parseUnsigned(name, optarg);
+            break;
+          case 'p': params.historyPoolSize = parseUnsigned(name, optarg); break;
+          case 'x':
+            params.indexFunction = parseIndexFunction(optarg);
+            break;
+          case 'P': params.packedPHT = true; break;
+          case 'T': params.taggedWays = parseUnsigned(name, optarg); break;
+          case 'a': params.tagBits = parseUnsigned(name, optarg); break;
+          case 'm': params.bimodalSize = parseUnsigned(name, optarg); break;
+          case 'K': params.specializedKernels = false; break;
+          case 'b': params.BTBEntries = parseUnsigned(name, optarg); break;
+          case 't': params.BTBTagSize = parseUnsigned(name, optarg); break;
+          case 'i': params.instShiftAmt = parseUnsigned(name, optarg); break;
+          case 'r': params.profileEntries = parseUnsigned(name, optarg); break;
+          case 'n': params.profileTopN = parseUnsigned(name, optarg); break;
+          case 'F': params.profileFormat = optarg; break;
+          case 'o': simout.setDirectory(optarg); break;
+          case 'S': dump_stats = true; break;
+          case 'L': params.callLog = true; break;
+          case 'C': checkpoint_at = parseUnsigned(name, optarg); break;
+          case 'D': checkpoint_dir = optarg; break;
+          case 'R': restore_dir = optarg; break;
+          case 'W': warm_branches = parseUnsigned(name, optarg); break;
+          default:
+            usage(argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<BranchRecord> text_trace;
+    BranchTraceReader binary_trace;
+    const bool binary = BranchTraceReader::isBranchTrace(argv[optind]);
+    std::string err;
+    if (binary ? !binary_trace.open(argv[optind], err) :
+                 !loadBranchStream(argv[optind], text_trace, err)) {
+        std::fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    const size_t trace_size =
+        binary ? binary_trace.size() : text_trace.size();
+
+    // Pass branches [begin, end) to fn. @return false on a corrupt chunk.
+    auto for_range = [&](size_t begin, size_t end, auto &&fn) {
+        if (!binary) {
+            for (size_t i = begin; i < end; i++) {
+                fn(text_trace[i]);
+            }
+            return true;
+        }
+        BranchTraceReader::Cursor cursor = binary_trace.cursor(begin);
+        BranchRecord br;
+        for (size_t i = begin; i < end; i++) {
+            if (!cursor.next(br)) {
+                std::fprintf(stderr, "%s: corrupt chunk\n", argv[optind]);
+                return false;
+            }
+            fn(br);
+        }
+        return true;
+    };
+
+    GSelectBP bp(params);
+    BPredDriver driver(bp, params.BTBEntries, params.BTBTagSize,
+                       params.instShiftAmt);
+
+    size_t first = 0;
+    if (!restore_dir.empty()) {
+        CheckpointIn cp(restore_dir);
+        bp.unserializeSection(cp, params.name);
+        driver.unserializeSection(cp, "driver");
+        first = driver.resumePoint();
+        if (first > trace_size) {
+            std::fprintf(stderr, "checkpoint is past the end of the trace\n");
+            return 1;
+        }
+    }
+    bp.startup();
+    const size_t warm_begin = first;
+    const size_t warm_end = std::min<size_t>(first + warm_branches,
+                                             trace_size);
+    const auto warm_start = std::chrono::steady_clock::now();
+    const bool warmed = for_range(first, warm_end,
+                                  [&](const BranchRecord &br) {
+        bp.warm(0, br.pc, br.conditional, br.taken);
+        driver.warmBTB(0, br);
+    });
+    if (!warmed) {
+        return 1;
+    }
+    const std::chrono::duration<double> warm_elapsed =
+        std::chrono::steady_clock::now() - warm_start;
+    first = warm_end;
+
+    size_t last = trace_size;
+    if (checkpoint_at && first + checkpoint_at < last) {
+        last = first + checkpoint_at;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const bool replayed = for_range(first, last,
+                                    [&](const BranchRecord &br) {
+        driver.replay(0, br);
+    });
+    if (!replayed) {
+        return 1;
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    if (checkpoint_at) {
+        if (mkdir(checkpoint_dir.c_str(), 0777) != 0 && errno != EEXIST) {
+            std::fprintf(stderr, "can't create %s\n", checkpoint_dir.c_str());
+            return 1;
+        }
+        CheckpointIn::setDir(checkpoint_dir);
+        std::ofstream cp(checkpoint_dir + "/" + CheckpointIn::baseFilename);
+        bp.serializeSection(cp, params.name);
+        driver.serializeSection(cp, "driver");
+    }
+
+    const BPredDriver::Counts &counts = driver.getCounts();
+    std::printf("branches          %llu\n",
+                (unsigned long long)counts.branches);
+    std::printf("condPredicted     %llu\n",
+                (unsigned long long)counts.condPredicted);
+    std::printf("condIncorrect     %llu\n",
+                (unsigned long long)counts.mispredicts);
+    std::printf("condMispredicts   %llu\n",
+                (unsigned long long)counts.condMispredicts);
+    std::printf("BTBLookups        %llu\n",
+                (unsigned long long)counts.btbLookups);
+    std::printf("BTBHits           %llu\n",
+                (unsigned long long)counts.btbHits);
+    if (counts.insts) {
+        std::printf("insts             %llu\n",
+                    (unsigned long long)counts.insts);
+        std::printf("MPKI              %.4f\n",
+                    1000.0 * counts.mispredicts / counts.insts);
+    }
+    if (warm_branches) {
+        std::printf("warmedBranches    %llu\n",
+                    (unsigned long long)(warm_end - warm_begin));
+        std::printf("warmSeconds       %.6f\n", warm_elapsed.count());
+    }
+    std::printf("seconds           %.6f\n", elapsed.count());
+    std::printf("branchesPerSecond %.0f\n",
+                elapsed.count() > 0 ? counts.branches / elapsed.count() : 0.0);
+
+    if (dump_stats) {
+        Stats::processDumpCallbacks();
+        bp.dumpStats(std::cout, params.name);
+    }
+    processExitCallbacks();
+    return 0;
+}
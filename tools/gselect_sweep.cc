@@ -0,0 +1,468 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Single-pass design space sweep of GSelectBP geometries.
+ *
+ *     gselect_sweep [options] <trace>
+ *
+ * Every combination of --sizes, --ctr-bits and --hist-bits is evaluated
+ * over one decode of the trace. Each configuration (a lane) keeps its own
+ * raw counter table, history and BTB; all counter tables live in one
+ * cache-line aligned arena. The trace is consumed in blocks small enough
+ * to stay cache resident while every lane runs over them, so the sweep
+ * costs roughly one trace read plus one pass over each lane's tables.
+ *
+ * A lane reproduces GSelectBP driven by BPredDriver step for step, so it
+ * reports the same misprediction counts as gselect_replay for the same
+ * configuration. Lanes only model the direct-mapped PHT indexed by the
+ * unfolded history concatenated above the PC bits; the options that
+ * select anything else are accepted so that a gselect_replay command
+ * line can be reused, and rejected when they leave that model.
+ */
+
+#include <getopt.h>
+#include <strings.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/bitfield.hh"
+#include "base/intmath.hh"
+#include "branch_stream.hh"
+#include "params/GSelectBP.hh"
+
+namespace
+{
+
+/** Trace branches processed by every lane before moving on. */
+const size_t BlockSize = 4096;
+
+const size_t CacheLineBytes = 64;
+
+struct SweepConfig
+{
+    unsigned predictorSize;
+    unsigned ctrBits;
+    unsigned historyBits;
+};
+
+/** Decoded trace branch, packed for streaming. */
+struct SweepBranch
+{
+    uint64_t pc;
+    uint64_t target;
+    uint8_t taken;
+    uint8_t conditional;
+};
+
+/** One configuration's predictor and BTB state. */
+struct Lane
+{
+    SweepConfig config;
+
+    uint64_t historyMask;
+    unsigned branchAddressBits;
+    uint64_t branchAddressMask;
+    uint64_t indexMask;
+    uint8_t threshold;
+    uint8_t ctrMax;
+
+    uint64_t history;
+    uint8_t *counters;
+
+    uint64_t mispredicts;
+    uint64_t condMispredicts;
+};
+
+struct BTBEntry
+{
+    uint64_t tag;
+    uint64_t target;
+    bool valid;
+};
+
+/** BTB geometry shared by every lane. */
+struct BTBConfig
+{
+    unsigned entries;
+    unsigned tagBits;
+    unsigned instShiftAmt;
+};
+
+/**
+ * The parameter a lane cannot reproduce GSelectBP under, or nullptr.
+ * packedPHT and specializedKernels only change how the same counters
+ * are stored and updated, and threadHashedIndex leaves the index of
+ * thread 0, the only thread of a trace, unchanged.
+ */
+const char *
+unmodelled(const GSelectBPParams &params)
+{
+    if (params.indexFunction != Enums::Concat) {
+        return "indexFunction";
+    }
+    if (params.foldedHistoryBits) {
+        return "foldedHistoryBits";
+    }
+    if (params.taggedWays) {
+        return "taggedWays";
+    }
+    return nullptr;
+}
+
+/**
+ * Run a lane over a block of branches. Mirrors GSelectBP::lookup(),
+ * uncondBranch(), btbUpdate() and update() as called by BPredDriver.
+ */
+void
+runLane(Lane &lane, BTBEntry *btb, const BTBConfig &btb_cfg,
+        const SweepBranch *begin, const SweepBranch *end)
+{
+    const unsigned shift = btb_cfg.instShiftAmt;
+    const uint64_t btb_idx_mask = btb_cfg.entries - 1;
+    const unsigned btb_tag_shift = shift + floorLog2(btb_cfg.entries);
+    const uint64_t btb_tag_mask = mask(btb_cfg.tagBits);
+
+    const uint64_t hmask = lane.historyMask;
+    const unsigned pc_bits = lane.branchAddressBits;
+    const uint64_t pc_mask = lane.branchAddressMask;
+    const uint64_t idx_mask = lane.indexMask;
+    const uint8_t threshold = lane.threshold;
+    const uint8_t ctr_max = lane.ctrMax;
+    uint8_t *const counters = lane.counters;
+    uint64_t history = lane.history;
+    uint64_t mispredicts = 0;
+    uint64_t cond_mispredicts = 0;
+
+    for (const SweepBranch *br = begin; br != end; br++) {
+        const uint64_t pc_idx = (br->pc >> shift) & pc_mask;
+        const uint64_t snapshot = history & hmask;
+
+        bool pred_taken = true;
+        if (br->conditional) {
+            const uint64_t idx = ((snapshot << pc_bits) | pc_idx) & idx_mask;
+            pred_taken = counters[idx] > threshold;
+        }
+        history = ((history << 1) | pred_taken) & hmask;
+
+        uint64_t pred_target = 0;
+        BTBEntry &entry = btb[(br->pc >> shift) & btb_idx_mask];
+        const uint64_t tag = (br->pc >> btb_tag_shift) & btb_tag_mask;
+        if (pred_taken) {
+            if (entry.valid && entry.tag == tag) {
+                pred_target = entry.target;
+            } else {
+                pred_taken = false;
+                history &= hmask & ~1ULL;
+            }
+        }
+
+        if (pred_taken != br->taken ||
+                (br->taken && pred_target != br->target)) {
+            mispredicts++;
+            cond_mispredicts += br->conditional;
+            history = ((snapshot << 1) | br->taken) & hmask;
+            if (br->taken) {
+                entry.valid = true;
+                entry.tag = tag;
+                entry.target = br->target;
+            }
+        }
+
+        const uint64_t idx = ((snapshot << pc_bits) | pc_idx) & idx_mask;
+        uint8_t ctr = counters[idx];
+        if (br->taken) {
+            ctr += ctr < ctr_max;
+        } else {
+            ctr -= ctr > 0;
+        }
+        counters[idx] = ctr;
+    }
+
+    lane.history = history;
+    lane.mispredicts += mispredicts;
+    lane.condMispredicts += cond_mispredicts;
+}
+
+std::vector<unsigned>
+parseList(const char *opt, const char *arg)
+{
+    std::vector<unsigned> values;
+    const char *p = arg;
+    while (*p) {
+        char *end;
+        const unsigned long v = std::strtoul(p, &end, 0);
+        if (end == p || (*end != ',' && *end != '\0')) {
+            std::fprintf(stderr, "invalid list '%s' for --%s\n", arg, opt);
+            std::exit(1);
+        }
+        values.push_back(v);
+        p = *end ? end + 1 : end;
+    }
+    return values;
+}
+
+Enums::GSelectIndexFunction
+parseIndexFunction(const char *arg)
+{
+    for (int i = 0; i < Enums::Num_GSelectIndexFunction; i++) {
+        if (strcasecmp(arg, Enums::GSelectIndexFunctionStrings[i]) == 0) {
+            return static_cast<Enums::GSelectIndexFunction>(i);
+        }
+    }
+    std::fprintf(stderr, "unknown index function '%s'\n", arg);
+    std::exit(1);
+}
+
+void
+usage(const char *prog)
+{
+    std::fprintf(stderr,
+        "usage: %s [options] <trace>\n"
+        "  --sizes LIST      PredictorSize values (default 1024)\n"
+        "  --ctr-bits LIST   PHTCtrBits values (default 2)\n"
+        "  --hist-bits LIST  globalHistoryBits values (default 8)\n"
+        "  --btb-entries N   BTBEntries (default 4096)\n"
+        "  --btb-tag-bits N  BTBTagSize (default 16)\n"
+        "  --inst-shift N    instShiftAmt (default 2)\n"
+        "  --folded-bits N, --index NAME, --tagged-ways N\n"
+        "                    as for gselect_replay; only the defaults,\n"
+        "                    which lanes model, are accepted\n"
+        "  --packed, --no-kernels\n"
+        "                    accepted and ignored: they do not change\n"
+        "                    predictions\n"
+        "  --jobs N          host threads to spread lanes over (default 1)\n"
+        "  --csv             print the result table as CSV\n"
+        "LISTs are comma separated; every combination is evaluated.\n",
+        prog);
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char **argv)
+{
+    std::vector<unsigned> sizes = {1024};
+    std::vector<unsigned> ctr_bits = {2};
+    std::vector<unsigned> hist_bits = {8};
+    GSelectBPParams params;
+    BTBConfig btb_cfg = {params.BTBEntries, params.BTBTagSize,
+                         params.instShiftAmt};
+    unsigned jobs = 1;
+    bool csv = false;
+
+    static const struct option long_opts[] = {
+        {"sizes", required_argument, nullptr, 's'},
+        {"ctr-bits", required_argument, nullptr, 'c'},
+        {"hist-bits", required_argument, nullptr, 'g'},
+        {"btb-entries", required_argument, nullptr, 'b'},
+        {"btb-tag-bits", required_argument, nullptr, 't'},
+        {"inst-shift", required_argument, nullptr, 'i'},
+        {"folded-bits", required_argument, nullptr, 'f'},
+        {"index", required_argument, nullptr, 'x'},
+        {"tagged-ways", required_argument, nullptr, 'T'},
+        {"packed", no_argument, nullptr, 'P'},
+        {"no-kernels", no_argument, nullptr, 'K'},
+        {"jobs", required_argument, nullptr, 'j'},
+        {"csv", no_argument, nullptr, 'C'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    int opt_idx;
+    while ((c = getopt_long(argc, argv, "h", long_opts, &opt_idx)) != -1) {
+        const char *name = c == '?' || c == 'h' ? "" :
+            long_opts[opt_idx].name;
+        switch (c) {
+          case 's': sizes = parseList(name, optarg); break;
+          case 'c': ctr_bits = parseList(name, optarg); break;
+          case 'g': hist_bits = parseList(name, optarg); break;
+          case 'b': btb_cfg.entries = parseList(name, optarg).at(0); break;
+          case 't': btb_cfg.tagBits = parseList(name, optarg).at(0); break;
+          case 'i': btb_cfg.instShiftAmt = parseList(name, optarg).at(0); break;
+          case 'f':
+            params.foldedHistoryBits = parseList(name, optarg).at(0);
+            break;
+          case 'x':
+            params.indexFunction = parseIndexFunction(optarg);
+            break;
+          case 'T': params.taggedWays = parseList(name, optarg).at(0); break;
+          case 'P': params.packedPHT = true; break;
+          case 'K': params.specializedKernels = false; break;
+          case 'j': jobs = std::max(1u, parseList(name, optarg).at(0)); break;
+          case 'C': csv = true; break;
+          default:
+            usage(argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (const char *param = unmodelled(params)) {
+        std::fprintf(stderr, "gselect_sweep only models the default %s; "
+                     "use gselect_replay for this configuration\n", param);
+        return 1;
+    }
+    if (!isPowerOf2(btb_cfg.entries)) {
+        std::fprintf(stderr, "BTB entries is not a power of 2\n");
+        return 1;
+    }
+
+    std::vector<SweepConfig> configs;
+    for (unsigned size : sizes) {
+        for (unsigned ctr : ctr_bits) {
+            for (unsigned hist : hist_bits) {
+                if (!isPowerOf2(size) || ctr == 0 || ctr > 8 ||
+                        hist > (unsigned)ceilLog2(size)) {
+                    std::fprintf(stderr, "skipping invalid configuration "
+                                 "size=%u ctr=%u hist=%u\n", size, ctr, hist);
+                    continue;
+                }
+                configs.push_back({size, ctr, hist});
+            }
+        }
+    }
+    if (configs.empty()) {
+        std::fprintf(stderr, "no valid configurations\n");
+        return 1;
+    }
+
+    // Decode the trace once into the packed form every lane streams over.
+    std::vector<BranchRecord> records;
+    std::string err;
+    if (!loadBranchStream(argv[optind], records, err)) {
+        std::fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    std::vector<SweepBranch> trace;
+    trace.reserve(records.size());
+    uint64_t insts = 0;
+    for (const BranchRecord &br : records) {
+        trace.push_back({br.pc, br.target, br.taken, br.conditional});
+        insts += br.instDelta;
+    }
+    records.clear();
+    records.shrink_to_fit();
+
+    // Lay every lane's counter table out back to back, each starting on
+    // its own cache line, and give each lane a private BTB.
+    size_t counter_bytes = 0;
+    std::vector<size_t> offsets;
+    for (const SweepConfig &cfg : configs) {
+        offsets.push_back(counter_bytes);
+        counter_bytes += divCeil(cfg.predictorSize, CacheLineBytes) *
+            CacheLineBytes;
+    }
+    void *arena_mem = nullptr;
+    if (posix_memalign(&arena_mem, CacheLineBytes, counter_bytes) != 0) {
+        std::fprintf(stderr, "cannot allocate %zu bytes of counters\n",
+                     counter_bytes);
+        return 1;
+    }
+    std::unique_ptr<uint8_t, decltype(&std::free)> arena(
+        static_cast<uint8_t *>(arena_mem), &std::free);
+    std::memset(arena.get(), 0, counter_bytes);
+
+    std::vector<Lane> lanes(configs.size());
+    std::vector<std::vector<BTBEntry>> btbs(configs.size(),
+        std::vector<BTBEntry>(btb_cfg.entries, {0, 0, false}));
+    for (size_t i = 0; i < configs.size(); i++) {
+        const SweepConfig &cfg = configs[i];
+        Lane &lane = lanes[i];
+        lane.config = cfg;
+        lane.historyMask = mask(cfg.historyBits);
+        lane.branchAddressBits = ceilLog2(cfg.predictorSize) - cfg.historyBits;
+        lane.branchAddressMask = mask(lane.branchAddressBits);
+        lane.indexMask = mask(ceilLog2(cfg.predictorSize));
+        lane.threshold = (1ULL << (cfg.ctrBits - 1)) - 1;
+        lane.ctrMax = mask(cfg.ctrBits);
+        lane.history = 0;
+        lane.counters = arena.get() + offsets[i];
+        lane.mispredicts = 0;
+        lane.condMispredicts = 0;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    auto worker = [&](size_t first, size_t last) {
+        for (size_t pos = 0; pos < trace.size(); pos += BlockSize) {
+            const SweepBranch *begin = trace.data() + pos;
+            const SweepBranch *end =
+                trace.data() + std::min(pos + BlockSize, trace.size());
+            for (size_t i = first; i < last; i++) {
+                runLane(lanes[i], btbs[i].data(), btb_cfg, begin, end);
+            }
+        }
+    };
+    jobs = std::min<size_t>(jobs, lanes.size());
+    std::vector<std::thread> threads;
+    for (unsigned j = 1; j < jobs; j++) {
+        threads.emplace_back(worker, lanes.size() * j / jobs,
+                             lanes.size() * (j + 1) / jobs);
+    }
+    worker(0, lanes.size() / jobs);
+    for (std::thread &t : threads) {
+        t.join();
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    if (csv) {
+        std::printf("PredictorSize,PHTCtrBits,globalHistoryBits,"
+                    "branches,condIncorrect,condMispredicts,MPKI\n");
+    } else {
+        std::printf("%13s %10s %17s %12s %13s %15s %9s\n",
+                    "PredictorSize", "PHTCtrBits", "globalHistoryBits",
+                    "branches", "condIncorrect", "condMispredicts", "MPKI");
+    }
+    for (const Lane &lane : lanes) {
+        const double mpki = insts ? 1000.0 * lane.mispredicts / insts : 0.0;
+        std::printf(csv ? "%u,%u,%u,%llu,%llu,%llu,%.4f\n" :
+                    "%13u %10u %17u %12llu %13llu %15llu %9.4f\n",
+                    lane.config.predictorSize, lane.config.ctrBits,
+                    lane.config.historyBits,
+                    (unsigned long long)trace.size(),
+                    (unsigned long long)lane.mispredicts,
+                    (unsigned long long)lane.condMispredicts, mpki);
+    }
+    std::fprintf(stderr, "%zu configurations x %zu branches in %.3f s\n",
+                 lanes.size(), trace.size(), elapsed.count());
+    return 0;
+}
@@ -0,0 +1,870 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Host-cost microbenchmarks of the GSelectBP and LRUIPVRP entry points:
+ *
+ *     hotpath_bench [options]
+ *
+ * Each case drives one model with a synthetic stream and times every
+ * entry point separately. GSelectBP sees loop, random and correlated
+ * conditional branches; LRUIPVRP sees streaming, thrashing and
+ * reuse-heavy accesses. For every entry point the case reports calls,
+ * ns/op and heap allocations/op, and for the whole case the hardware
+ * cache-miss and related counts from perf_event_open, where the host
+ * allows them.
+ *
+ * Calls are timed in batches grouped by entry point so the clock is
+ * read once per batch rather than once per call:
+ *
+ *  - GSelectBP looks up a batch of branches, then resolves and commits
+ *    them in order, as a core with that many branches in flight would.
+ *  - LRUIPVRP batches hold one access per set. Sets do not share
+ *    recency state, so running the touches, then the victim selections,
+ *    invalidations and fills of a batch leaves every set exactly as the
+ *    accesses in stream order would.
+ *
+ * --json writes the results for regression tracking.
+ */
+
+#include <getopt.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cpu/pred/gselect.hh"
+#include "mem/cache/replacement_policies/lru_ipv.hh"
+
+namespace
+{
+
+/** Heap allocations made through operator new so far. */
+uint64_t heapAllocs = 0;
+
+} // anonymous namespace
+
+void *
+operator new(size_t size)
+{
+    heapAllocs++;
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *
+operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *
+operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    heapAllocs++;
+    return std::malloc(size ? size : 1);
+}
+
+void *
+operator new[](size_t size, const std::nothrow_t &tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void *
+operator new(size_t size, std::align_val_t align)
+{
+    heapAllocs++;
+    const size_t alignment = static_cast<size_t>(align);
+    const size_t rounded = (size + alignment - 1) / alignment * alignment;
+    if (void *ptr = std::aligned_alloc(alignment, rounded ? rounded :
+                                                            alignment)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void *
+operator new[](size_t size, std::align_val_t align)
+{
+    return operator new(size, align);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+void
+operator delete(void *ptr, size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+void
+operator delete[](void *ptr, size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+/** Cost of one back-to-back pair of clock reads, taken off each batch. */
+double clockOverhead = 0;
+
+void
+calibrateClock()
+{
+    double best = 1e9;
+    for (unsigned i = 0; i < 10000; i++) {
+        const auto t0 = Clock::now();
+        const auto t1 = Clock::now();
+        best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+    }
+    clockOverhead = best;
+}
+
+/** Time, calls and allocations of one entry point within a case. */
+struct EntryPoint
+{
+    const char *name;
+    uint64_t calls = 0;
+    uint64_t allocs = 0;
+    double seconds = 0;
+
+    explicit EntryPoint(const char *name) : name(name) {}
+
+    double nsPerOp() const { return calls ? 1e9 * seconds / calls : 0; }
+
+    double
+    allocsPerOp() const
+    {
+        return calls ? double(allocs) / calls : 0;
+    }
+};
+
+/**
+ * Accounts one batch of calls to an entry point:
+ *
+ *     { Timed timed(ep); for (...) { ...; ep.calls++; } }
+ */
+class Timed
+{
+  public:
+    explicit Timed(EntryPoint &ep)
+        : ep(ep), allocs(heapAllocs), start(Clock::now())
+    {}
+
+    ~Timed()
+    {
+        const double elapsed =
+            std::chrono::duration<double>(Clock::now() - start).count();
+        ep.seconds += std::max(0.0, elapsed - clockOverhead);
+        ep.allocs += heapAllocs - allocs;
+    }
+
+  private:
+    EntryPoint &ep;
+    const uint64_t allocs;
+    const Clock::time_point start;
+};
+
+/**
+ * User-mode hardware counters of this thread. Each counter is opened on
+ * its own, so a host that lacks some of them still reports the rest;
+ * virtual machines often provide none.
+ */
+class PerfCounters
+{
+  public:
+    static const unsigned NumCounters = 6;
+
+    PerfCounters()
+    {
+        static const struct { uint32_t type; uint64_t config; } events[] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        };
+        for (unsigned i = 0; i < NumCounters; i++) {
+            struct perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[i].type;
+            attr.config = events[i].config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+    }
+
+    ~PerfCounters()
+    {
+        for (int fd : fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    static const char *
+    name(unsigned i)
+    {
+        static const char *const names[NumCounters] = {
+            "cycles", "instructions", "cacheReferences", "cacheMisses",
+            "l1dReadMisses", "branchMisses"};
+        return names[i];
+    }
+
+    void
+    start()
+    {
+        for (int fd : fds) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+    }
+
+    void
+    stop()
+    {
+        for (int fd : fds) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+    }
+
+    /** @return Whether counter i is available, with its count in val. */
+    bool
+    read(unsigned i, uint64_t &val) const
+    {
+        return fds[i] >= 0 &&
+            ::read(fds[i], &val, sizeof(val)) == (ssize_t)sizeof(val);
+    }
+
+  private:
+    int fds[NumCounters];
+};
+
+/** Results of one benchmark case. */
+struct CaseResult
+{
+    std::string name;
+    std::vector<EntryPoint> entryPoints;
+    /** Case specific outcome counts, e.g. mispredictions. */
+    std::vector<std::pair<const char *, uint64_t>> metrics;
+    bool counterValid[PerfCounters::NumCounters] = {};
+    uint64_t counters[PerfCounters::NumCounters] = {};
+
+    uint64_t
+    calls() const
+    {
+        uint64_t total = 0;
+        for (const EntryPoint &ep : entryPoints) {
+            total += ep.calls;
+        }
+        return total;
+    }
+
+    double
+    seconds() const
+    {
+        double total = 0;
+        for (const EntryPoint &ep : entryPoints) {
+            total += ep.seconds;
+        }
+        return total;
+    }
+};
+
+struct Options
+{
+    uint64_t ops = 2000000;
+    unsigned repeat = 3;
+    uint64_t seed = 1;
+    std::string filter;
+    GSelectBPParams gselect;
+    LRUIPVRPParams lruIpv;
+    unsigned sets = 1024;
+    /** Branches in flight per GSelectBP batch. */
+    unsigned window = 64;
+};
+
+/* GSelectBP */
+
+struct Branch
+{
+    Addr pc;
+    bool taken;
+};
+
+/**
+ * Nested loops: 64 loop branches with trip counts between 2 and 40,
+ * each taken until its last iteration.
+ */
+void
+loopBranches(uint64_t n, std::mt19937_64 &rng, std::vector<Branch> &out)
+{
+    std::vector<unsigned> trips(64);
+    for (unsigned &trip : trips) {
+        trip = 2 + rng() % 39;
+    }
+    while (out.size() < n) {
+        for (unsigned loop = 0; loop < trips.size() && out.size() < n;
+             loop++) {
+            for (unsigned iter = 1; iter <= trips[loop]; iter++) {
+                out.push_back({0x400000 + 64 * Addr(loop),
+                               iter != trips[loop]});
+            }
+        }
+    }
+    out.resize(n);
+}
+
+/** 4096 static branches at random, each taken with probability 1/2. */
+void
+randomBranches(uint64_t n, std::mt19937_64 &rng, std::vector<Branch> &out)
+{
+    std::vector<Addr> pcs(4096);
+    for (Addr &pc : pcs) {
+        pc = 0x400000 + 4 * (rng() % (1 << 20));
+    }
+    while (out.size() < n) {
+        const uint64_t r = rng();
+        out.push_back({pcs[r % pcs.size()], bool(r >> 63)});
+    }
+}
+
+/**
+ * 256 branch sites, each the XOR of two of the last eight outcomes
+ * with 1/32 noise. The next site depends on the current site and its
+ * outcome, as in a control flow graph.
+ */
+void
+correlatedBranches(uint64_t n, std::mt19937_64 &rng,
+                   std::vector<Branch> &out)
+{
+    struct Site { unsigned a, b; };
+    std::vector<Site> sites(256);
+    for (Site &site : sites) {
+        site.a = rng() % 8;
+        site.b = rng() % 8;
+    }
+    uint64_t history = 0;
+    unsigned site = 0;
+    while (out.size() < n) {
+        bool taken = ((history >> sites[site].a) ^
+                      (history >> sites[site].b)) & 1;
+        if (rng() % 32 == 0) {
+            taken = !taken;
+        }
+        out.push_back({0x400000 + 16 * Addr(site), taken});
+        history = (history << 1) | taken;
+        site = (site * 5 + 1 + (taken ? 3 : 0)) % sites.size();
+    }
+}
+
+CaseResult
+runGSelect(const Options &opts, const std::vector<Branch> &branches,
+           PerfCounters &perf)
+{
+    CaseResult result;
+    result.entryPoints = {EntryPoint("lookup"), EntryPoint("update")};
+    EntryPoint &lookup = result.entryPoints[0];
+    EntryPoint &update = result.entryPoints[1];
+
+    GSelectBP bp(opts.gselect);
+    std::vector<void *> histories(opts.window);
+    std::vector<uint8_t> preds(opts.window);
+    uint64_t mispredicts = 0;
+
+    perf.start();
+    for (size_t base = 0; base < branches.size(); base += opts.window) {
+        const size_t count =
+            std::min<size_t>(opts.window, branches.size() - base);
+        const Branch *batch = &branches[base];
+        {
+            Timed timed(lookup);
+            for (size_t i = 0; i < count; i++) {
+                preds[i] = bp.lookup(0, batch[i].pc, histories[i]);
+            }
+            lookup.calls += count;
+        }
+        {
+            Timed timed(update);
+            for (size_t i = 0; i < count; i++) {
+                if (preds[i] != batch[i].taken) {
+                    mispredicts++;
+                    bp.update(0, batch[i].pc, batch[i].taken, histories[i],
+                              true, nullptr, 0);
+                    update.calls++;
+                }
+                bp.update(0, batch[i].pc, batch[i].taken, histories[i],
+                          false, nullptr, 0);
+            }
+            update.calls += count;
+        }
+    }
+    perf.stop();
+
+    result.metrics = {{"branches", branches.size()},
+                      {"mispredicts", mispredicts}};
+    return result;
+}
+
+/* LRUIPVRP */
+
+/** Tag of each access; access i goes to set i % sets. */
+typedef std::vector<uint32_t> AccessStream;
+
+/** Every access to a set brings in a block never seen before. */
+void
+streamingAccesses(const Options &opts, std::mt19937_64 &rng,
+                  AccessStream &out)
+{
+    for (uint64_t i = 0; i < opts.ops; i++) {
+        out.push_back(i / opts.sets);
+    }
+}
+
+/** Each set cycles through 1.5 times its associativity in blocks. */
+void
+thrashingAccesses(const Options &opts, std::mt19937_64 &rng,
+                  AccessStream &out)
+{
+    const unsigned cycle = opts.lruIpv.numWays + opts.lruIpv.numWays / 2;
+    for (uint64_t i = 0; i < opts.ops; i++) {
+        out.push_back((i / opts.sets) % cycle);
+    }
+}
+
+/**
+ * 7 in 8 accesses go to a hot half-set of blocks, the rest to four
+ * times the associativity in cold blocks.
+ */
+void
+reuseAccesses(const Options &opts, std::mt19937_64 &rng, AccessStream &out)
+{
+    const unsigned hot = std::max(1u, opts.lruIpv.numWays / 2);
+    const unsigned cold = 4 * opts.lruIpv.numWays;
+    for (uint64_t i = 0; i < opts.ops; i++) {
+        const uint64_t r = rng();
+        out.push_back(r % 8 ? r % hot : hot + (r >> 32) % cold);
+    }
+}
+
+struct Block : public ReplaceableEntry
+{
+    uint32_t tag = 0;
+    bool valid = false;
+};
+
+CaseResult
+runLRUIPV(const Options &opts, const AccessStream &accesses,
+          PerfCounters &perf)
+{
+    CaseResult result;
+    result.entryPoints = {EntryPoint("touch"), EntryPoint("getVictim"),
+                          EntryPoint("invalidate"), EntryPoint("reset")};
+    EntryPoint &touch = result.entryPoints[0];
+    EntryPoint &get_victim = result.entryPoints[1];
+    EntryPoint &invalidate = result.entryPoints[2];
+    EntryPoint &reset = result.entryPoints[3];
+
+    const unsigned ways = opts.lruIpv.numWays;
+    ReplacementPolicy::LRUIPVRP rp(opts.lruIpv);
+    std::vector<Block> blocks(opts.sets * ways);
+    std::vector<ReplacementCandidates> candidates(opts.sets);
+    for (unsigned idx = 0; idx < blocks.size(); idx++) {
+        blocks[idx].setPosition(idx / ways, idx % ways);
+        blocks[idx].replacementData = rp.instantiateEntry();
+        candidates[idx / ways].push_back(&blocks[idx]);
+    }
+    rp.regStats();
+
+    std::vector<Block *> hits, misses, victims, evicted;
+    hits.reserve(opts.sets);
+    misses.reserve(opts.sets);
+    victims.reserve(opts.sets);
+    evicted.reserve(opts.sets);
+    uint64_t hit_count = 0;
+
+    perf.start();
+    for (size_t base = 0; base < accesses.size(); base += opts.sets) {
+        const size_t count =
+            std::min<size_t>(opts.sets, accesses.size() - base);
+        hits.clear();
+        misses.clear();
+        for (size_t set = 0; set < count; set++) {
+            Block *way = &blocks[set * ways];
+            Block *hit = nullptr;
+            for (unsigned w = 0; w < ways; w++) {
+                if (way[w].valid && way[w].tag == accesses[base + set]) {
+                    hit = &way[w];
+                    break;
+                }
+            }
+            if (hit) {
+                hits.push_back(hit);
+            } else {
+                // Remember the set through its first block.
+                misses.push_back(way);
+            }
+        }
+        hit_count += hits.size();
+
+        {
+            Timed timed(touch);
+            for (Block *blk : hits) {
+                rp.touch(blk->replacementData);
+            }
+            touch.calls += hits.size();
+        }
+
+        victims.clear();
+        {
+            Timed timed(get_victim);
+            for (Block *first : misses) {
+                victims.push_back(static_cast<Block *>(
+                    rp.getVictim(candidates[first->getSet()])));
+            }
+            get_victim.calls += misses.size();
+        }
+
+        evicted.clear();
+        for (Block *victim : victims) {
+            if (victim->valid) {
+                evicted.push_back(victim);
+            }
+            victim->valid = true;
+            victim->tag = accesses[base + victim->getSet()];
+        }
+        {
+            Timed timed(invalidate);
+            for (Block *victim : evicted) {
+                rp.invalidate(victim->replacementData);
+            }
+            invalidate.calls += evicted.size();
+        }
+        {
+            Timed timed(reset);
+            for (Block *victim : victims) {
+                rp.reset(victim->replacementData);
+            }
+            reset.calls += victims.size();
+        }
+    }
+    perf.stop();
+
+    result.metrics = {{"accesses", accesses.size()}, {"hits", hit_count},
+                      {"misses", accesses.size() - hit_count}};
+    return result;
+}
+
+/**
+ * Run a case opts.repeat times on fresh models and keep the fastest
+ * run, whose counters are reported along with it.
+ */
+template <class Run>
+CaseResult
+bestOf(const Options &opts, const std::string &name, Run &&run)
+{
+    CaseResult best;
+    for (unsigned rep = 0; rep < opts.repeat; rep++) {
+        PerfCounters perf;
+        CaseResult result = run(perf);
+        for (unsigned i = 0; i < PerfCounters::NumCounters; i++) {
+            result.counterValid[i] = perf.read(i, result.counters[i]);
+        }
+        if (rep == 0 || result.seconds() < best.seconds()) {
+            best = std::move(result);
+        }
+    }
+    best.name = name;
+    return best;
+}
+
+void
+printText(const std::vector<CaseResult> &results)
+{
+    for (const CaseResult &result : results) {
+        std::printf("%s\n", result.name.c_str());
+        for (const EntryPoint &ep : result.entryPoints) {
+            std::printf("  %-12s %10llu calls %9.2f ns/op %7.3f allocs/op\n",
+                        ep.name, (unsigned long long)ep.calls, ep.nsPerOp(),
+                        ep.allocsPerOp());
+        }
+        std::printf(" ");
+        for (const auto &metric : result.metrics) {
+            std::printf(" %s %llu", metric.first,
+                        (unsigned long long)metric.second);
+        }
+        std::printf("\n ");
+        for (unsigned i = 0; i < PerfCounters::NumCounters; i++) {
+            if (result.counterValid[i]) {
+                std::printf(" %s %.3f/op", PerfCounters::name(i),
+                            double(result.counters[i]) / result.calls());
+            } else {
+                std::printf(" %s n/a", PerfCounters::name(i));
+            }
+        }
+        std::printf("\n");
+    }
+}
+
+void
+printJSON(FILE *out, const Options &opts,
+          const std::vector<CaseResult> &results)
+{
+    std::fprintf(out, "{\n  \"ops\": %llu,\n  \"repeat\": %u,\n"
+                 "  \"seed\": %llu,\n  \"clockOverheadNs\": %.2f,\n"
+                 "  \"cases\": [",
+                 (unsigned long long)opts.ops, opts.repeat,
+                 (unsigned long long)opts.seed, 1e9 * clockOverhead);
+    const char *sep = "\n";
+    for (const CaseResult &result : results) {
+        std::fprintf(out, "%s    {\n      \"name\": \"%s\",\n"
+                     "      \"entryPoints\": [", sep, result.name.c_str());
+        const char *ep_sep = "\n";
+        for (const EntryPoint &ep : result.entryPoints) {
+            std::fprintf(out, "%s        {\"name\": \"%s\", \"calls\": %llu, "
+                         "\"nsPerOp\": %.3f, \"allocsPerOp\": %.4f}",
+                         ep_sep, ep.name, (unsigned long long)ep.calls,
+                         ep.nsPerOp(), ep.allocsPerOp());
+            ep_sep = ",\n";
+        }
+        std::fprintf(out, "\n      ],\n      \"metrics\": {");
+        const char *m_sep = "";
+        for (const auto &metric : result.metrics) {
+            std::fprintf(out, "%s\"%s\": %llu", m_sep, metric.first,
+                         (unsigned long long)metric.second);
+            m_sep = ", ";
+        }
+        std::fprintf(out, "},\n      \"counters\": {");
+        for (unsigned i = 0; i < PerfCounters::NumCounters; i++) {
+            std::fprintf(out, i ? ", \"%s\": " : "\"%s\": ",
+                         PerfCounters::name(i));
+            if (result.counterValid[i]) {
+                std::fprintf(out, "%llu",
+                             (unsigned long long)result.counters[i]);
+            } else {
+                std::fprintf(out, "null");
+            }
+        }
+        std::fprintf(out, "}\n    }");
+        sep = ",\n";
+    }
+    std::fprintf(out, "\n  ]\n}\n");
+}
+
+void
+usage(const char *prog)
+{
+    std::fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --ops N           calls driven per case (default 2000000)\n"
+        "  --repeat N        runs per case, the fastest is kept (default 3)\n"
+        "  --seed N          stream generator seed (default 1)\n"
+        "  --filter S        only run cases whose name contains S\n"
+        "  --json FILE       also write the results as JSON, - for stdout\n"
+        "  --size N          GSelectBP PredictorSize (default 1024)\n"
+        "  --hist-bits N     GSelectBP globalHistoryBits (default 8)\n"
+        "  --packed          GSelectBP packedPHT\n"
+        "  --tagged-ways N   GSelectBP taggedWays (default 0)\n"
+        "  --window N        branches in flight per batch (default 64)\n"
+        "  --sets N          LRUIPVRP sets (default 1024)\n"
+        "  --ways N          LRUIPVRP numWays (default 16)\n"
+        "  --compact         LRUIPVRP compactRecency\n",
+        prog);
+}
+
+unsigned
+parseUnsigned(const char *opt, const char *arg)
+{
+    char *end;
+    const unsigned long v = std::strtoul(arg, &end, 0);
+    if (*arg == '\0' || *end != '\0') {
+        std::fprintf(stderr, "invalid value '%s' for --%s\n", arg, opt);
+        std::exit(1);
+    }
+    return v;
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char **argv)
+{
+    Options opts;
+    opts.gselect.name = "gselect";
+    opts.lruIpv.name = "replacement_policy";
+    std::string json_file;
+
+    static const struct option long_opts[] = {
+        {"ops", required_argument, nullptr, 'n'},
+        {"repeat", required_argument, nullptr, 'r'},
+        {"seed", required_argument, nullptr, 'S'},
+        {"filter", required_argument, nullptr, 'f'},
+        {"json", required_argument, nullptr, 'j'},
+        {"size", required_argument, nullptr, 's'},
+        {"hist-bits", required_argument, nullptr, 'g'},
+        {"packed", no_argument, nullptr, 'P'},
+        {"tagged-ways", required_argument, nullptr, 'T'},
+        {"window", required_argument, nullptr, 'W'},
+        {"sets", required_argument, nullptr, 'e'},
+        {"ways", required_argument, nullptr, 'w'},
+        {"compact", no_argument, nullptr, 'c'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    int opt_idx;
+    while ((c = getopt_long(argc, argv, "h", long_opts, &opt_idx)) != -1) {
+        const char *name = c == '?' || c == 'h' ? "" :
+            long_opts[opt_idx].name;
+        switch (c) {
+          case 'n': opts.ops = parseUnsigned(name, optarg); break;
+          case 'r': opts.repeat = parseUnsigned(name, optarg); break;
+          case 'S': opts.seed = parseUnsigned(name, optarg); break;
+          case 'f': opts.filter = optarg; break;
+          case 'j': json_file = optarg; break;
+          case 's':
+            opts.gselect.PredictorSize = parseUnsigned(name, optarg);
+            break;
+          case 'g':
+            opts.gselect.globalHistoryBits = parseUnsigned(name, optarg);
+            break;
+          case 'P': opts.gselect.packedPHT = true; break;
+          case 'T':
+            opts.gselect.taggedWays = parseUnsigned(name, optarg);
+            break;
+          case 'W': opts.window = parseUnsigned(name, optarg); break;
+          case 'e': opts.sets = parseUnsigned(name, optarg); break;
+          case 'w': opts.lruIpv.numWays = parseUnsigned(name, optarg); break;
+          case 'c': opts.lruIpv.compactRecency = true; break;
+          default:
+            usage(argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    if (optind != argc || !opts.ops || !opts.repeat || !opts.window ||
+            !opts.sets) {
+        usage(argv[0]);
+        return 1;
+    }
+    // Every branch of a batch is in flight at once.
+    opts.gselect.historyPoolSize =
+        std::max(opts.gselect.historyPoolSize, 2 * opts.window);
+
+    calibrateClock();
+
+    typedef void (*BranchGen)(uint64_t, std::mt19937_64 &,
+                              std::vector<Branch> &);
+    static const struct { const char *name; BranchGen gen; } branchCases[] = {
+        {"gselect/loop", loopBranches},
+        {"gselect/random", randomBranches},
+        {"gselect/correlated", correlatedBranches},
+    };
+    typedef void (*AccessGen)(const Options &, std::mt19937_64 &,
+                              AccessStream &);
+    static const struct { const char *name; AccessGen gen; } accessCases[] = {
+        {"lru_ipv/streaming", streamingAccesses},
+        {"lru_ipv/thrashing", thrashingAccesses},
+        {"lru_ipv/reuse", reuseAccesses},
+    };
+
+    std::vector<CaseResult> results;
+    for (const auto &bc : branchCases) {
+        if (std::string(bc.name).find(opts.filter) == std::string::npos) {
+            continue;
+        }
+        std::mt19937_64 rng(opts.seed);
+        std::vector<Branch> branches;
+        branches.reserve(opts.ops);
+        bc.gen(opts.ops, rng, branches);
+        results.push_back(bestOf(opts, bc.name, [&](PerfCounters &perf) {
+            return runGSelect(opts, branches, perf);
+        }));
+    }
+    for (const auto &ac : accessCases) {
+        if (std::string(ac.name).find(opts.filter) == std::string::npos) {
+            continue;
+        }
+        std::mt19937_64 rng(opts.seed);
+        AccessStream accesses;
+        accesses.reserve(opts.ops);
+        ac.gen(opts, rng, accesses);
+        results.push_back(bestOf(opts, ac.name, [&](PerfCounters &perf) {
+            return runLRUIPV(opts, accesses, perf);
+        }));
+    }
+
+    printText(results);
+    if (!json_file.empty()) {
+        FILE *out = json_file == "-" ? stdout :
+            std::fopen(json_file.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "cannot open %s\n", json_file.c_str());
+            return 1;
+        }
+        printJSON(out, opts, results);
+        if (out != stdout) {
+            std::fclose(out);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A flat, policy-specialised LRU-IPV cache for the offline tools.
+ */
+
+#include "ipv_cache.hh"
+
+#include <cstring>
+#include <numeric>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+IPVCache::IPVCache(unsigned num_sets, unsigned assoc,
+                   const std::vector<unsigned> &ipv)
+    : assoc(assoc), stride(1u << ceilLog2(assoc)),
+      tags(uint64_t(num_sets) * assoc, Invalid),
+      lruWays(num_sets, uint64_t(1) << (assoc - 1)),
+      promotion(assoc)
+{
+    fatal_if(assoc < 2 || assoc > 64 || !isPowerOf2(assoc),
+             "IPVCache needs a power of 2 between 2 and 64 ways.\n");
+    fatal_if(ipv.size() != assoc + 1, "The IPV needs %d entries.\n",
+             assoc + 1);
+
+    void *ptr = nullptr;
+    fatal_if(posix_memalign(&ptr, 64, uint64_t(num_sets) * stride) != 0,
+             "Failed to allocate recency stacks.\n");
+    recency.reset(static_cast<uint8_t *>(ptr));
+    for (unsigned set = 0; set < num_sets; set++) {
+        uint8_t *stack = recency.get() + uint64_t(set) * stride;
+        std::memset(stack, 0, stride);
+        std::iota(stack, stack + assoc, 0);
+    }
+
+    for (unsigned pos = 0; pos < assoc; pos++) {
+        fatal_if(ipv[pos] >= assoc, "IPV entry %d is out of range.\n", pos);
+        promotion[pos] = ipv[pos];
+    }
+    fatal_if(ipv[assoc] >= assoc, "IPV insertion position is out of range.\n");
+    insertion = ipv[assoc];
+}
@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A flat, policy-specialised LRU-IPV cache for the offline tools.
+ */
+
+#ifndef __TOOLS_IPV_CACHE_HH__
+#define __TOOLS_IPV_CACHE_HH__
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "mem/cache/replacement_policies/lru_ipv_kernels.hh"
+
+/**
+ * A set-associative cache with LRU-IPV replacement that makes the same
+ * stack updates as LRUIPVRP driven by CacheModel (touch on a hit; victim
+ * from the LRU mask, invalidate and reset on a miss) through the same
+ * kernels, but without SimObjects, per-block replacement data or
+ * virtual calls. It is cheap enough to build one per candidate IPV.
+ */
+class IPVCache
+{
+  public:
+    /**
+     * @param num_sets Number of sets.
+     * @param assoc Ways per set, a power of 2 between 2 and 64.
+     * @param ipv Insertion/promotion vector, assoc + 1 entries, each
+     * below assoc; see LRUIPVRP.
+     */
+    IPVCache(unsigned num_sets, unsigned assoc,
+             const std::vector<unsigned> &ipv);
+
+    /**
+     * Look up a block, filling it on a miss.
+     *
+     * @param set Set index.
+     * @param tag Block tag; any value but ~0.
+     * @param victim_way If given, set to the way filled on a miss.
+     * @return Whether it hit.
+     */
+    bool
+    access(uint32_t set, uint64_t tag, unsigned *victim_way = nullptr)
+    {
+        uint64_t *set_tags = &tags[uint64_t(set) * assoc];
+        uint8_t *stack = recency.get() + uint64_t(set) * stride;
+        for (unsigned way = 0; way < assoc; way++) {
+            if (set_tags[way] == tag) {
+                const unsigned target = clamp(stack[way]);
+                lruWays[set] = ReplacementPolicy::lruIpvPromote(
+                    stack, assoc, stride, target, promotion[target]);
+                return true;
+            }
+        }
+
+        const uint64_t lru = lruWays[set];
+        const unsigned victim = lru ? 63 - __builtin_clzll(lru) : 0;
+        if (victim_way) {
+            *victim_way = victim;
+        }
+        if (set_tags[victim] != Invalid) {
+            ReplacementPolicy::lruIpvDemote(stack, assoc, stride,
+                                            clamp(stack[victim]), assoc);
+        }
+        set_tags[victim] = tag;
+        lruWays[set] = ReplacementPolicy::lruIpvPromote(
+            stack, assoc, stride, clamp(stack[victim]), insertion);
+        return false;
+    }
+
+    /** Tag of an empty way. */
+    static const uint64_t Invalid = ~uint64_t(0);
+
+  private:
+    struct AlignedFree
+    {
+        void operator()(uint8_t *ptr) const { free(ptr); }
+    };
+
+    unsigned clamp(unsigned pos) const
+    {
+        return pos < assoc ? pos : assoc - 1;
+    }
+
+    const unsigned assoc;
+    const unsigned stride;
+    std::vector<uint64_t> tags;
+    std::unique_ptr<uint8_t[], AlignedFree> recency;
+    std::vector<uint64_t> lruWays;
+    std::vector<uint8_t> promotion;
+    uint8_t insertion;
+};
+
+#endif // __TOOLS_IPV_CACHE_HH__
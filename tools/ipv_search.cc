@@ -0,0 +1,355 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Offline genetic search for LRU-IPV insertion/promotion vectors.
+ *
+ * Follows the search in the IPV paper: a population of vectors is
+ * evolved by tournament selection, two-point crossover and per-entry
+ * mutation, with the best vectors carried over unchanged, and each
+ * vector is scored by the misses it takes on a recorded LLC access
+ * trace:
+ *
+ *     ipv_search [options] <trace>...
+ *
+ * Every trace is searched separately and the best vector for each is
+ * written to the output file. Candidates are scored with IPVCache,
+ * which makes the same stack updates as LRUIPVRP, on a work-stealing
+ * pool spanning all host threads; decoded traces are cached on disk.
+ */
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ipv_cache.hh"
+#include "llc_trace.hh"
+#include "work_stealing_pool.hh"
+
+namespace
+{
+
+typedef std::vector<unsigned> IPV;
+
+void
+usage(const char *prog)
+{
+    std::fprintf(stderr,
+        "usage: %s [options] <trace>...\n"
+        "  --sets N          sets of the LLC (default 2048)\n"
+        "  --ways N          associativity, 2 to 64 (default 16)\n"
+        "  --block-size N    block size in bytes (default 64)\n"
+        "  --population N    vectors per generation (default 64)\n"
+        "  --generations N   generations to evolve (default 30)\n"
+        "  --elite N         best vectors kept unchanged (default 4)\n"
+        "  --mutation P      per-entry mutation probability (default 0.05)\n"
+        "  --seed N          random seed (default 1)\n"
+        "  --jobs N          worker threads (default: all)\n"
+        "  --max-accesses N  only use the first N accesses of each trace\n"
+        "  --cache-dir DIR   where decoded traces are kept\n"
+        "                    (default .ipv_cache, empty to disable)\n"
+        "  --out FILE        where the best vectors go (default ipv_best.txt)\n",
+        prog);
+}
+
+uint64_t
+parseUnsigned(const char *opt, const char *arg)
+{
+    char *end;
+    const unsigned long long v = std::strtoull(arg, &end, 0);
+    if (*arg == '\0' || *end != '\0') {
+        std::fprintf(stderr, "invalid value '%s' for --%s\n", arg, opt);
+        std::exit(1);
+    }
+    return v;
+}
+
+double
+parseDouble(const char *opt, const char *arg)
+{
+    char *end;
+    const double v = std::strtod(arg, &end);
+    if (*arg == '\0' || *end != '\0') {
+        std::fprintf(stderr, "invalid value '%s' for --%s\n", arg, opt);
+        std::exit(1);
+    }
+    return v;
+}
+
+std::string
+formatIPV(const IPV &ipv)
+{
+    std::string out;
+    for (size_t i = 0; i < ipv.size(); i++) {
+        out += (i ? "," : "") + std::to_string(ipv[i]);
+    }
+    return out;
+}
+
+uint64_t
+countMisses(const LLCTrace &trace, const IPV &ipv)
+{
+    IPVCache cache(trace.numSets, trace.assoc, ipv);
+    uint64_t misses = 0;
+    for (size_t i = 0; i < trace.size(); i++) {
+        misses += !cache.access(trace.sets[i], trace.tags[i]);
+    }
+    return misses;
+}
+
+/** Search state of one trace. */
+struct Workload
+{
+    LLCTrace trace;
+    std::vector<IPV> population;
+    std::vector<uint64_t> misses;
+    /** Scores of every vector seen so far; elites are not rescored. */
+    std::map<IPV, uint64_t> scored;
+    uint64_t lruMisses = 0;
+    uint64_t paperMisses = 0;
+};
+
+} // anonymous namespace
+
+int
+main(int argc, char **argv)
+{
+    unsigned num_sets = 2048;
+    unsigned ways = 16;
+    unsigned block_size = 64;
+    unsigned population = 64;
+    unsigned generations = 30;
+    unsigned elite = 4;
+    double mutation = 0.05;
+    uint64_t seed = 1;
+    unsigned jobs = 0;
+    uint64_t max_accesses = 0;
+    std::string cache_dir = ".ipv_cache";
+    std::string out_file = "ipv_best.txt";
+
+    static const struct option long_opts[] = {
+        {"sets", required_argument, nullptr, 's'},
+        {"ways", required_argument, nullptr, 'w'},
+        {"block-size", required_argument, nullptr, 'b'},
+        {"population", required_argument, nullptr, 'p'},
+        {"generations", required_argument, nullptr, 'g'},
+        {"elite", required_argument, nullptr, 'e'},
+        {"mutation", required_argument, nullptr, 'm'},
+        {"seed", required_argument, nullptr, 'r'},
+        {"jobs", required_argument, nullptr, 'j'},
+        {"max-accesses", required_argument, nullptr, 'n'},
+        {"cache-dir", required_argument, nullptr, 'c'},
+        {"out", required_argument, nullptr, 'o'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    int opt_idx;
+    while ((c = getopt_long(argc, argv, "h", long_opts, &opt_idx)) != -1) {
+        const char *name = c == '?' || c == 'h' ? "" :
+            long_opts[opt_idx].name;
+        switch (c) {
+          case 's': num_sets = parseUnsigned(name, optarg); break;
+          case 'w': ways = parseUnsigned(name, optarg); break;
+          case 'b': block_size = parseUnsigned(name, optarg); break;
+          case 'p': population = parseUnsigned(name, optarg); break;
+          case 'g': generations = parseUnsigned(name, optarg); break;
+          case 'e': elite = parseUnsigned(name, optarg); break;
+          case 'm': mutation = parseDouble(name, optarg); break;
+          case 'r': seed = parseUnsigned(name, optarg); break;
+          case 'j': jobs = parseUnsigned(name, optarg); break;
+          case 'n': max_accesses = parseUnsigned(name, optarg); break;
+          case 'c': cache_dir = optarg; break;
+          case 'o': out_file = optarg; break;
+          default:
+            usage(argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    if (optind == argc || population < 2 || elite >= population ||
+            ways < 2 || ways > 64 || (ways & (ways - 1))) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<Workload> workloads(argc - optind);
+    for (size_t w = 0; w < workloads.size(); w++) {
+        std::string err;
+        if (!loadLLCTrace(argv[optind + w], num_sets, ways, block_size,
+                          max_accesses, cache_dir, workloads[w].trace,
+                          err)) {
+            std::fprintf(stderr, "%s\n", err.c_str());
+            return 1;
+        }
+    }
+
+    WorkStealingPool pool(jobs);
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<unsigned> position(0, ways - 1);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    // Seed every population with LRU, LIP and the paper's vector; the
+    // rest is random.
+    const IPV lru_ipv(ways + 1, 0);
+    IPV lip_ipv(ways + 1, 0);
+    lip_ipv[ways] = ways - 1;
+    const IPV paper_ipv = ReplacementPolicy::lruIpvDefaultIPV(ways);
+    for (Workload &wl : workloads) {
+        wl.population = {lru_ipv, lip_ipv, paper_ipv};
+        while (wl.population.size() < population) {
+            IPV ipv(ways + 1);
+            for (unsigned &entry : ipv) {
+                entry = position(rng);
+            }
+            wl.population.push_back(ipv);
+        }
+        wl.population.resize(population);
+    }
+
+    uint64_t evaluations = 0;
+    for (unsigned gen = 0; gen <= generations; gen++) {
+        // Score everything not scored before, across all workloads in
+        // one batch.
+        std::vector<std::pair<size_t, IPV>> pending;
+        for (size_t w = 0; w < workloads.size(); w++) {
+            std::vector<IPV> fresh;
+            for (const IPV &ipv : workloads[w].population) {
+                if (!workloads[w].scored.count(ipv) &&
+                        std::find(fresh.begin(), fresh.end(), ipv) ==
+                        fresh.end()) {
+                    fresh.push_back(ipv);
+                }
+            }
+            for (const IPV &ipv : fresh) {
+                pending.emplace_back(w, ipv);
+            }
+        }
+        std::vector<uint64_t> scores(pending.size());
+        pool.run(pending.size(), [&](size_t i, unsigned) {
+            scores[i] = countMisses(workloads[pending[i].first].trace,
+                                    pending[i].second);
+        });
+        evaluations += pending.size();
+        for (size_t i = 0; i < pending.size(); i++) {
+            workloads[pending[i].first].scored[pending[i].second] = scores[i];
+        }
+
+        for (Workload &wl : workloads) {
+            std::sort(wl.population.begin(), wl.population.end(),
+                      [&](const IPV &a, const IPV &b) {
+                          return wl.scored[a] < wl.scored[b];
+                      });
+            wl.misses.clear();
+            for (const IPV &ipv : wl.population) {
+                wl.misses.push_back(wl.scored[ipv]);
+            }
+            if (gen == 0) {
+                wl.lruMisses = wl.scored[lru_ipv];
+                wl.paperMisses = wl.scored[paper_ipv];
+            }
+            std::fprintf(stderr, "%s gen %u best %llu (LRU %llu)\n",
+                         wl.trace.name.c_str(), gen,
+                         (unsigned long long)wl.misses[0],
+                         (unsigned long long)wl.lruMisses);
+        }
+        if (gen == generations) {
+            break;
+        }
+
+        for (Workload &wl : workloads) {
+            auto tournament = [&]() -> const IPV & {
+                std::uniform_int_distribution<unsigned> pick(
+                    0, population - 1);
+                unsigned best = pick(rng);
+                for (int round = 1; round < 4; round++) {
+                    best = std::min(best, pick(rng));
+                }
+                return wl.population[best];
+            };
+
+            std::vector<IPV> next(wl.population.begin(),
+                                  wl.population.begin() + elite);
+            std::uniform_int_distribution<unsigned> cut(0, ways + 1);
+            while (next.size() < population) {
+                const IPV &a = tournament();
+                const IPV &b = tournament();
+                unsigned lo = cut(rng);
+                unsigned hi = cut(rng);
+                if (lo > hi) {
+                    std::swap(lo, hi);
+                }
+                IPV child = a;
+                for (unsigned i = lo; i < hi; i++) {
+                    child[i] = b[i];
+                }
+                for (unsigned &entry : child) {
+                    if (chance(rng) < mutation) {
+                        entry = position(rng);
+                    }
+                }
+                next.push_back(child);
+            }
+            wl.population = std::move(next);
+        }
+    }
+
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::ofstream out(out_file);
+    out << "# workload misses lru_misses paper_misses accesses ipv\n";
+    for (const Workload &wl : workloads) {
+        out << wl.trace.name << " " << wl.misses[0] << " " << wl.lruMisses
+            << " " << wl.paperMisses << " " << wl.trace.size() << " "
+            << formatIPV(wl.population[0]) << "\n";
+        std::printf("%-24s misses %llu (LRU %llu, paper %llu) ipv %s\n",
+                    wl.trace.name.c_str(), (unsigned long long)wl.misses[0],
+                    (unsigned long long)wl.lruMisses,
+                    (unsigned long long)wl.paperMisses,
+                    formatIPV(wl.population[0]).c_str());
+    }
+    std::printf("evaluations       %llu\n", (unsigned long long)evaluations);
+    std::printf("threads           %u\n", pool.size());
+    std::printf("seconds           %.3f\n", elapsed.count());
+    std::printf("evaluationsPerMin %.0f\n",
+                elapsed.count() > 0 ? 60 * evaluations / elapsed.count() : 0);
+    return 0;
+}
@@ -0,0 +1,195 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * LLC access traces pre-split into set indices and tags, with an on-disk
+ * cache of the decoded form.
+ */
+
+#include "llc_trace.hh"
+
+#include <sys/stat.h>
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include "address_stream.hh"
+#include "base/intmath.hh"
+
+namespace
+{
+
+/** Header of a decoded trace; the sets and then the tags follow. */
+struct DecodedHeader
+{
+    char magic[8];
+    /** Device and inode of the source, which its path may not pin. */
+    uint64_t sourceDev;
+    uint64_t sourceIno;
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    uint32_t numSets;
+    uint32_t assoc;
+    uint32_t blockSize;
+    uint32_t pad;
+    uint64_t maxAccesses;
+    uint64_t count;
+};
+
+const char DecodedMagic[8] = {'L', 'L', 'C', 'T', 'R', 'C', '2', '\0'};
+
+std::string
+baseName(const std::string &path)
+{
+    const size_t slash = path.rfind('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+/** FNV-1a of a canonical path, to tell same-named traces apart. */
+std::string
+pathKey(const std::string &path)
+{
+    char resolved[PATH_MAX];
+    const std::string canonical =
+        realpath(path.c_str(), resolved) ? resolved : path;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : canonical) {
+        hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)hash);
+    return hex;
+}
+
+bool
+readDecoded(const std::string &file, const DecodedHeader &want,
+            LLCTrace &trace)
+{
+    std::ifstream in(file, std::ios::binary);
+    DecodedHeader header;
+    if (!in.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+        return false;
+    }
+    if (std::memcmp(header.magic, want.magic, sizeof(header.magic)) != 0 ||
+            header.sourceDev != want.sourceDev ||
+            header.sourceIno != want.sourceIno ||
+            header.sourceSize != want.sourceSize ||
+            header.sourceMtime != want.sourceMtime ||
+            header.numSets != want.numSets || header.assoc != want.assoc ||
+            header.blockSize != want.blockSize ||
+            header.maxAccesses != want.maxAccesses) {
+        return false;
+    }
+    trace.sets.resize(header.count);
+    trace.tags.resize(header.count);
+    in.read(reinterpret_cast<char *>(trace.sets.data()),
+            header.count * sizeof(uint32_t));
+    in.read(reinterpret_cast<char *>(trace.tags.data()),
+            header.count * sizeof(uint64_t));
+    return bool(in);
+}
+
+} // anonymous namespace
+
+bool
+loadLLCTrace(const std::string &path, unsigned num_sets, unsigned assoc,
+             unsigned block_size, uint64_t max_accesses,
+             const std::string &cache_dir, LLCTrace &trace,
+             std::string &err)
+{
+    if (!isPowerOf2(num_sets) || !isPowerOf2(block_size)) {
+        err = "sets and block size must be powers of 2";
+        return false;
+    }
+
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        err = "cannot open " + path;
+        return false;
+    }
+
+    trace.name = baseName(path);
+    trace.numSets = num_sets;
+    trace.assoc = assoc;
+    trace.blockSize = block_size;
+
+    DecodedHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, DecodedMagic, sizeof(header.magic));
+    header.sourceDev = st.st_dev;
+    header.sourceIno = st.st_ino;
+    header.sourceSize = st.st_size;
+    header.sourceMtime = st.st_mtime;
+    header.numSets = num_sets;
+    header.assoc = assoc;
+    header.blockSize = block_size;
+    header.maxAccesses = max_accesses;
+
+    const std::string cached = cache_dir.empty() ? "" :
+        cache_dir + "/" + trace.name + "." + pathKey(path) + "." +
+        std::to_string(num_sets) + "x" +
+        std::to_string(assoc) + "x" + std::to_string(block_size) +
+        (max_accesses ? "." + std::to_string(max_accesses) : "") + ".llc";
+    if (!cached.empty() && readDecoded(cached, header, trace)) {
+        return true;
+    }
+
+    std::vector<uint64_t> addrs;
+    if (!loadAddressStream(path, addrs, err)) {
+        return false;
+    }
+    if (max_accesses && addrs.size() > max_accesses) {
+        addrs.resize(max_accesses);
+    }
+
+    const unsigned block_shift = floorLog2(block_size);
+    const unsigned set_shift = floorLog2(num_sets);
+    trace.sets.resize(addrs.size());
+    trace.tags.resize(addrs.size());
+    for (size_t i = 0; i < addrs.size(); i++) {
+        const uint64_t blk = addrs[i] >> block_shift;
+        trace.sets[i] = blk & (num_sets - 1);
+        trace.tags[i] = blk >> set_shift;
+    }
+
+    if (!cached.empty()) {
+        mkdir(cache_dir.c_str(), 0777);
+        header.count = trace.size();
+        std::ofstream out(cached, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(trace.sets.data()),
+                  trace.size() * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char *>(trace.tags.data()),
+                  trace.size() * sizeof(uint64_t));
+    }
+    return true;
+}
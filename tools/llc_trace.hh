@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * LLC access traces pre-split into set indices and tags, with an on-disk
+ * cache of the decoded form.
+ */
+
+#ifndef __TOOLS_LLC_TRACE_HH__
+#define __TOOLS_LLC_TRACE_HH__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** An address stream decoded for one cache geometry. */
+struct LLCTrace
+{
+    std::string name;
+    unsigned numSets = 0;
+    unsigned assoc = 0;
+    unsigned blockSize = 0;
+    std::vector<uint32_t> sets;
+    std::vector<uint64_t> tags;
+
+    size_t size() const { return sets.size(); }
+};
+
+/**
+ * Load an address trace (see loadAddressStream()) decoded for a cache
+ * geometry. The decoded trace is kept in cache_dir, keyed by the trace's
+ * canonical path, file identity, size and modification time and by the
+ * geometry, so later runs skip parsing the text entirely. Traces of the
+ * same name in different directories get separate entries.
+ *
+ * @param path Address trace.
+ * @param num_sets Sets of the cache, a power of 2.
+ * @param assoc Ways of the cache.
+ * @param block_size Block size in bytes, a power of 2.
+ * @param max_accesses Keep only this many accesses, 0 for all.
+ * @param cache_dir Where decoded traces are kept; empty to not cache.
+ * @param trace Filled with the decoded trace.
+ * @param err Set to a description of the problem on failure.
+ * @return Whether the trace was loaded.
+ */
+bool loadLLCTrace(const std::string &path, unsigned num_sets,
+                  unsigned assoc, unsigned block_size, uint64_t max_accesses,
+                  const std::string &cache_dir, LLCTrace &trace,
+                  std::string &err);
+
+#endif // __TOOLS_LLC_TRACE_HH__
@@ -0,0 +1,249 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Randomized check of the LRU-IPV recency kernels against their scalar
+ * reference loops:
+ *
+ *     lru_ipv_kernel_check [--seed N] [--rounds N]
+ *
+ * Every set width from 1 to 64 ways runs random sequences of the
+ * promotions and invalidations LRUIPVRP makes, on a byte stack updated
+ * by the scalar loops, one updated by the vector versions and, up to 16
+ * ways, a packed set; after each step all three must agree position for
+ * position and on the LRU mask. The gathered LRU mask and the packed
+ * way-bit conversions are checked on random inputs too.
+ *
+ * Which vector paths are covered depends on the build: the Makefile
+ * builds this once for the host and once for baseline x86-64, so that
+ * both the AVX2/BMI2 and the SSE2/shift-and-mask versions are run.
+ */
+
+#include <getopt.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+#include "mem/cache/replacement_policies/lru_ipv_kernels.hh"
+
+using namespace ReplacementPolicy;
+
+namespace
+{
+
+unsigned failures = 0;
+
+void
+fail(const char *what, unsigned num_ways, unsigned step)
+{
+    if (failures++ < 10) {
+        std::fprintf(stderr, "%s differs at %u ways, step %u\n", what,
+                     num_ways, step);
+    }
+}
+
+/** Smallest power of 2 at least num_ways, as LRUIPVRP strides sets. */
+unsigned
+strideOf(unsigned num_ways)
+{
+    unsigned stride = 1;
+    while (stride < num_ways) {
+        stride *= 2;
+    }
+    return stride;
+}
+
+/**
+ * Run one random sequence of updates on a set of num_ways ways. Targets
+ * are a random way's clamped position, and new positions of promotions
+ * are within the stack, as they are in LRUIPVRP.
+ */
+void
+checkUpdates(std::mt19937_64 &rng, unsigned num_ways, unsigned steps)
+{
+    const unsigned stride = strideOf(num_ways);
+    alignas(32) uint8_t ref[64] = {};
+    alignas(32) uint8_t vec[64] = {};
+    for (unsigned way = 0; way < num_ways; way++) {
+        ref[way] = vec[way] = way;
+    }
+    const bool packable = num_ways <= 16;
+    uint64_t packed = 0;
+    uint16_t past_end = 0;
+    for (unsigned way = 0; packable && way < num_ways; way++) {
+        packed |= uint64_t(way) << (4 * way);
+    }
+
+    for (unsigned step = 0; step < steps; step++) {
+        const unsigned way = rng() % num_ways;
+        const unsigned target = ref[way] < num_ways ? ref[way] : num_ways - 1;
+        uint64_t ref_lru, vec_lru;
+        if (rng() % 4) {
+            const unsigned new_pos = rng() % num_ways;
+            ref_lru = lruIpvPromoteScalar(ref, num_ways, target, new_pos);
+            vec_lru = lruIpvPromote(vec, num_ways, stride, target, new_pos);
+            if (packable) {
+                lruIpvPromotePacked(packed, past_end, num_ways, target,
+                                    new_pos);
+            }
+        } else {
+            ref_lru = lruIpvDemoteScalar(ref, num_ways, target, num_ways);
+            vec_lru = lruIpvDemote(vec, num_ways, stride, target, num_ways);
+            if (packable) {
+                lruIpvDemotePacked(packed, past_end, num_ways, target);
+            }
+        }
+
+        if (std::memcmp(ref, vec, sizeof(ref)) != 0) {
+            fail("vector stack", num_ways, step);
+        }
+        if (ref_lru != vec_lru) {
+            fail("vector LRU mask", num_ways, step);
+        }
+        if (!packable) {
+            continue;
+        }
+        for (unsigned w = 0; w < num_ways; w++) {
+            const unsigned pos = (past_end >> w) & 1 ?
+                num_ways : (packed >> (4 * w)) & 0xF;
+            if (pos != ref[w]) {
+                fail("packed stack", num_ways, step);
+                break;
+            }
+        }
+        if (lruIpvLruMaskPacked(packed, num_ways) != ref_lru) {
+            fail("packed LRU mask", num_ways, step);
+        }
+    }
+}
+
+/** Gathered LRU masks of random positions, including invalid ones. */
+void
+checkLruMask(std::mt19937_64 &rng, unsigned num_ways, unsigned rounds)
+{
+    for (unsigned round = 0; round < rounds; round++) {
+        const unsigned count = 1 + rng() % 64;
+        alignas(16) uint8_t positions[64] = {};
+        for (unsigned i = 0; i < count; i++) {
+            positions[i] = rng() % (num_ways + 1);
+        }
+        if (lruIpvLruMask(positions, count, num_ways) !=
+                lruIpvLruMaskScalar(positions, count, num_ways)) {
+            fail("gathered LRU mask", num_ways, round);
+        }
+    }
+}
+
+/** lruIpvWayBits() and lruIpvWayFlags() against a loop over the ways. */
+void
+checkWayBits(std::mt19937_64 &rng, unsigned rounds)
+{
+    for (unsigned round = 0; round < rounds; round++) {
+        const uint64_t flags = rng();
+        const unsigned bits = rng() & 0xFFFF;
+        unsigned want_bits = 0;
+        uint64_t want_flags = 0;
+        for (unsigned way = 0; way < 16; way++) {
+            want_bits |= ((flags >> (4 * way + 3)) & 1) << way;
+            want_flags |= uint64_t((bits >> way) & 1) << (4 * way + 3);
+        }
+        if (lruIpvWayBits(flags) != want_bits) {
+            fail("way bits", 16, round);
+        }
+        if (lruIpvWayFlags(bits) != want_flags) {
+            fail("way flags", 16, round);
+        }
+    }
+}
+
+void
+usage(const char *prog)
+{
+    std::fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --seed N          random seed (default 1)\n"
+        "  --rounds N        update sequences per set width (default 200)\n",
+        prog);
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char **argv)
+{
+    unsigned long seed = 1;
+    unsigned rounds = 200;
+
+    static const struct option long_opts[] = {
+        {"seed", required_argument, nullptr, 's'},
+        {"rounds", required_argument, nullptr, 'r'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "h", long_opts, nullptr)) != -1) {
+        switch (c) {
+          case 's': seed = std::strtoul(optarg, nullptr, 0); break;
+          case 'r': rounds = std::strtoul(optarg, nullptr, 0); break;
+          default:
+            usage(argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+
+    std::mt19937_64 rng(seed);
+    for (unsigned num_ways = 1; num_ways <= 64; num_ways++) {
+        for (unsigned round = 0; round < rounds; round++) {
+            checkUpdates(rng, num_ways, 200);
+        }
+        checkLruMask(rng, num_ways, rounds * 10);
+    }
+    checkWayBits(rng, rounds * 100);
+
+    const char *paths =
+#if defined(__AVX2__)
+        "AVX2"
+#elif defined(__SSE2__)
+        "SSE2"
+#else
+        "scalar"
+#endif
+#if defined(__BMI2__)
+        ", BMI2";
+#else
+        ", no BMI2";
+#endif
+    std::printf("lru_ipv kernels (%s): %s\n", paths,
+                failures ? "FAIL" : "ok");
+    return failures ? 1 : 0;
+}
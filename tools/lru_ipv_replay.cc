@@ -0,0 +1,272 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Standalone trace-driven replay of the LRU-IPV replacement policy.
+ *
+ * The policy sources are compiled unchanged against the gem5 header shim
+ * and driven by CacheModel, so replacement behaviour and host cost can be
+ * measured without a full simulation:
+ *
+ *     lru_ipv_replay [options] [<trace>]
+ *
+ * Without a trace a synthetic stream is generated; run with --help for
+ * the options.
+ */
+
+#include <getopt.h>
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "address_stream.hh"
+#include "base/output.hh"
+#include "base/trace.hh"
+#include "cache_model.hh"
+#include "mem/cache/replacement_policies/lru_ipv.hh"
+
+namespace
+{
+
+void
+usage(const char *prog)
+{
+    std::fprintf(stderr,
+        "usage: %s [options] [<trace>]\n"
+        "  --sets N          number of sets (default 32768)\n"
+        "  --ways N          associativity (default 16)\n"
+        "  --block-size N    block size in bytes (default 64)\n"
+        "  --ipv LIST        comma separated insertion/promotion vector,\n"
+        "                    ways + 1 entries (default: rescaled paper IPV)\n"
+        "  --dueling-ipv LIST  another IPV to set-duel against --ipv;\n"
+        "                    may be repeated\n"
+        "  --constituency N  sets per dueling constituency (default 64)\n"
+        "  --compact         pack recency state 4 bits per way\n"
+        "  --synthetic N     accesses to generate without a trace\n"
+        "                    (default 10000000)\n"
+        "  --seed N          seed of the synthetic stream (default 1)\n"
+        "  --footprint N     bytes scanned by the synthetic stream\n"
+        "                    (default 1073741824)\n"
+        "  --debug-flags LIST  comma separated debug flags to enable;\n"
+        "                    LruIpv writes replacement_policy.ipvtrace\n"
+        "  --outdir DIR      where output files go (default .)\n"
+        "  --stats           dump the policy's stats after the run\n"
+        "  --check-victims N  after the run, check getVictim() on N\n"
+        "                    candidate lists spanning several sets; exits\n"
+        "                    non-zero if any victim breaks its rule\n",
+        prog);
+}
+
+uint64_t
+parseUnsigned(const char *opt, const char *arg)
+{
+    char *end;
+    const unsigned long long v = std::strtoull(arg, &end, 0);
+    if (*arg == '\0' || *end != '\0') {
+        std::fprintf(stderr, "invalid value '%s' for --%s\n", arg, opt);
+        std::exit(1);
+    }
+    return v;
+}
+
+std::vector<unsigned>
+parseList(const char *opt, const char *arg)
+{
+    std::vector<unsigned> values;
+    std::string item;
+    for (const char *p = arg; ; p++) {
+        if (*p == ',' || *p == '\0') {
+            values.push_back(parseUnsigned(opt, item.c_str()));
+            item.clear();
+            if (*p == '\0') {
+                break;
+            }
+        } else {
+            item += *p;
+        }
+    }
+    return values;
+}
+
+bool
+enableDebugFlags(const char *arg)
+{
+    std::string flag;
+    for (const char *p = arg; ; p++) {
+        if (*p == ',' || *p == '\0') {
+            if (!Debug::changeFlag(flag.c_str(), true)) {
+                std::fprintf(stderr, "unknown debug flag '%s'\n",
+                             flag.c_str());
+                return false;
+            }
+            flag.clear();
+            if (*p == '\0') {
+                return true;
+            }
+        } else {
+            flag += *p;
+        }
+    }
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char **argv)
+{
+    LRUIPVRPParams params;
+    params.name = "replacement_policy";
+    unsigned num_sets = 32768;
+    unsigned block_size = 64;
+    uint64_t synthetic = 10000000;
+    uint64_t seed = 1;
+    uint64_t footprint = 1ULL << 30;
+    bool dump_stats = false;
+    uint64_t check_victims = 0;
+
+    static const struct option long_opts[] = {
+        {"sets", required_argument, nullptr, 's'},
+        {"ways", required_argument, nullptr, 'w'},
+        {"block-size", required_argument, nullptr, 'b'},
+        {"ipv", required_argument, nullptr, 'v'},
+        {"dueling-ipv", required_argument, nullptr, 'd'},
+        {"constituency", required_argument, nullptr, 'C'},
+        {"compact", no_argument, nullptr, 'k'},
+        {"synthetic", required_argument, nullptr, 'n'},
+        {"seed", required_argument, nullptr, 'r'},
+        {"footprint", required_argument, nullptr, 'f'},
+        {"debug-flags", required_argument, nullptr, 'g'},
+        {"outdir", required_argument, nullptr, 'o'},
+        {"stats", no_argument, nullptr, 'S'},
+        {"check-victims", required_argument, nullptr, 'V'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    int opt_idx;
+    while ((c = getopt_long(argc, argv, "h", long_opts, &opt_idx)) != -1) {
+        const char *name = c == '?' || c == 'h' ? "" :
+            long_opts[opt_idx].name;
+        switch (c) {
+          case 's': num_sets = parseUnsigned(name, optarg); break;
+          case 'w': params.numWays = parseUnsigned(name, optarg); break;
+          case 'b': block_size = parseUnsigned(name, optarg); break;
+          case 'v': params.ipv = parseList(name, optarg); break;
+          case 'd': {
+            const std::vector<unsigned> ipv = parseList(name, optarg);
+            params.duelingIPVs.insert(params.duelingIPVs.end(), ipv.begin(),
+                                      ipv.end());
+            break;
+          }
+          case 'k': params.compactRecency = true; break;
+          case 'C':
+            params.duelingConstituency = parseUnsigned(name, optarg);
+            break;
+          case 'n': synthetic = parseUnsigned(name, optarg); break;
+          case 'r': seed = parseUnsigned(name, optarg); break;
+          case 'f': footprint = parseUnsigned(name, optarg); break;
+          case 'g':
+            if (!enableDebugFlags(optarg)) {
+                return 1;
+            }
+            break;
+          case 'o': simout.setDirectory(optarg); break;
+          case 'S': dump_stats = true; break;
+          case 'V': check_victims = parseUnsigned(name, optarg); break;
+          default:
+            usage(argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    if (optind < argc - 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<uint64_t> addrs;
+    if (optind == argc - 1) {
+        std::string err;
+        if (!loadAddressStream(argv[optind], addrs, err)) {
+            std::fprintf(stderr, "%s\n", err.c_str());
+            return 1;
+        }
+    } else {
+        synthesizeAddressStream(synthetic, seed, footprint, addrs);
+    }
+
+    struct rusage before;
+    getrusage(RUSAGE_SELF, &before);
+
+    ReplacementPolicy::LRUIPVRP rp(params);
+    CacheModel cache(rp, num_sets, params.numWays, block_size);
+    rp.regStats();
+
+    struct rusage after;
+    getrusage(RUSAGE_SELF, &after);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (const uint64_t addr : addrs) {
+        cache.access(addr);
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    const CacheModel::Counts &counts = cache.getCounts();
+    std::printf("accesses          %llu\n",
+                (unsigned long long)counts.accesses);
+    std::printf("hits              %llu\n", (unsigned long long)counts.hits);
+    std::printf("misses            %llu\n",
+                (unsigned long long)counts.misses);
+    std::printf("evictions         %llu\n",
+                (unsigned long long)counts.evictions);
+    std::printf("victimHash        %016llx\n",
+                (unsigned long long)counts.victimHash);
+    std::printf("setupKiB          %ld\n", after.ru_maxrss - before.ru_maxrss);
+    std::printf("seconds           %.6f\n", elapsed.count());
+    std::printf("nsPerAccess       %.2f\n",
+                counts.accesses ? 1e9 * elapsed.count() / counts.accesses : 0);
+    if (dump_stats) {
+        Stats::processDumpCallbacks();
+        rp.dumpStats(std::cout, params.name);
+    }
+    if (check_victims) {
+        const uint64_t failures = cache.checkVictims(check_victims, seed);
+        std::printf("victimCheck       %s (%llu of %llu lists wrong)\n",
+                    failures ? "FAIL" : "ok", (unsigned long long)failures,
+                    (unsigned long long)check_victims);
+        return failures ? 1 : 0;
+    }
+    return 0;
+}
@@ -0,0 +1,440 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Set-sharded parallel trace-driven simulation of an LRU-IPV cache.
+ *
+ * LRU-IPV keeps all of its state per set, so a cache splits into
+ * independent shards by set index. One decoder thread splits each
+ * address into set and tag and hands the accesses of every shard over a
+ * lock-free single-producer single-consumer queue, in batches, to a
+ * thread that owns that shard's sets. Each shard is an IPVCache, which
+ * makes the same stack updates as LRUIPVRP through the same kernels.
+ *
+ *     lru_ipv_sim [options] [<trace>]
+ *
+ * Every set sees its accesses in trace order whatever the sharding, so
+ * the totals and the per-set victim hash match a sequential run exactly;
+ * --check runs both and compares. Set dueling shares state between sets
+ * and cannot be sharded, so it is not supported here.
+ */
+
+#include <getopt.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "address_stream.hh"
+#include "base/intmath.hh"
+#include "ipv_cache.hh"
+#include "spsc_queue.hh"
+
+namespace
+{
+
+/** Accesses handed from the decoder to a shard at a time. */
+const unsigned BatchSize = 4096;
+
+/** Batches in flight per shard. */
+const unsigned BatchesPerShard = 8;
+
+struct Batch
+{
+    unsigned count = 0;
+    uint32_t sets[BatchSize];
+    uint64_t tags[BatchSize];
+};
+
+struct Geometry
+{
+    unsigned numSets = 32768;
+    unsigned assoc = 16;
+    unsigned blockShift = 6;
+    std::vector<unsigned> ipv;
+};
+
+struct Result
+{
+    uint64_t accesses = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    /** Combination of every set's order-sensitive victim hash. */
+    uint64_t setHash = 0;
+};
+
+/** The sets whose index has the given low bits, and their counters. */
+class Shard
+{
+  public:
+    Shard(const Geometry &geom, unsigned shard_bits, unsigned id)
+        : cache(geom.numSets >> shard_bits, geom.assoc, geom.ipv),
+          shardBits(shard_bits), id(id),
+          filledWays(geom.numSets >> shard_bits, 0),
+          victimHashes(geom.numSets >> shard_bits, 0),
+          full(BatchesPerShard), free(BatchesPerShard)
+    {
+        for (unsigned i = 0; i < BatchesPerShard; i++) {
+            batches.emplace_back(new Batch);
+            free.tryPush(batches.back().get());
+        }
+    }
+
+    void
+    access(uint32_t set, uint64_t tag)
+    {
+        unsigned way;
+        if (cache.access(set, tag, &way)) {
+            hits++;
+            return;
+        }
+        misses++;
+        const uint64_t bit = uint64_t(1) << way;
+        evictions += (filledWays[set] & bit) != 0;
+        filledWays[set] |= bit;
+        victimHashes[set] = (victimHashes[set] ^ way) * 0x100000001b3ULL;
+    }
+
+    /** Consume batches until the decoder sends nullptr. */
+    void
+    run()
+    {
+        for (;;) {
+            Batch *batch;
+            while (!full.tryPop(batch)) {
+                std::this_thread::yield();
+            }
+            if (!batch) {
+                return;
+            }
+            for (unsigned i = 0; i < batch->count; i++) {
+                access(batch->sets[i], batch->tags[i]);
+            }
+            batch->count = 0;
+            free.tryPush(batch);
+        }
+    }
+
+    void
+    addTo(Result &result) const
+    {
+        result.hits += hits;
+        result.misses += misses;
+        result.evictions += evictions;
+        for (uint64_t set = 0; set < victimHashes.size(); set++) {
+            const uint64_t global_set = set << shardBits | id;
+            uint64_t h = (victimHashes[set] + global_set) *
+                0x9e3779b97f4a7c15ULL;
+            result.setHash ^= h ^ (h >> 29);
+        }
+    }
+
+    IPVCache cache;
+    const unsigned shardBits;
+    const unsigned id;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    std::vector<uint64_t> filledWays;
+    std::vector<uint64_t> victimHashes;
+
+    /** Filled batches from the decoder, and empty ones going back. */
+    SPSCQueue<Batch *> full;
+    SPSCQueue<Batch *> free;
+    std::vector<std::unique_ptr<Batch>> batches;
+};
+
+Result
+runSequential(const Geometry &geom, const std::vector<uint64_t> &addrs,
+              unsigned repeat)
+{
+    Shard shard(geom, 0, 0);
+    const unsigned set_shift = floorLog2(geom.numSets);
+    const uint64_t set_mask = geom.numSets - 1;
+    for (unsigned rep = 0; rep < repeat; rep++) {
+        for (const uint64_t addr : addrs) {
+            const uint64_t blk = addr >> geom.blockShift;
+            shard.access(blk & set_mask, blk >> set_shift);
+        }
+    }
+
+    Result result;
+    result.accesses = addrs.size() * repeat;
+    shard.addTo(result);
+    return result;
+}
+
+Result
+runSharded(const Geometry &geom, const std::vector<uint64_t> &addrs,
+           unsigned repeat, unsigned num_shards)
+{
+    const unsigned shard_bits = floorLog2(num_shards);
+    std::vector<std::unique_ptr<Shard>> shards;
+    for (unsigned id = 0; id < num_shards; id++) {
+        shards.emplace_back(new Shard(geom, shard_bits, id));
+    }
+
+    std::vector<std::thread> threads;
+    for (auto &shard : shards) {
+        threads.emplace_back(&Shard::run, shard.get());
+    }
+
+    // The decoder: this thread.
+    auto take = [](Shard &shard) {
+        Batch *batch;
+        while (!shard.free.tryPop(batch)) {
+            std::this_thread::yield();
+        }
+        return batch;
+    };
+    auto send = [](Shard &shard, Batch *batch) {
+        while (!shard.full.tryPush(batch)) {
+            std::this_thread::yield();
+        }
+    };
+
+    std::vector<Batch *> open;
+    for (auto &shard : shards) {
+        open.push_back(take(*shard));
+    }
+
+    const unsigned set_shift = floorLog2(geom.numSets);
+    const uint64_t set_mask = geom.numSets - 1;
+    const uint64_t shard_mask = num_shards - 1;
+    for (unsigned rep = 0; rep < repeat; rep++) {
+        for (const uint64_t addr : addrs) {
+            const uint64_t blk = addr >> geom.blockShift;
+            const uint64_t set = blk & set_mask;
+            const unsigned id = set & shard_mask;
+            Batch *batch = open[id];
+            batch->sets[batch->count] = set >> shard_bits;
+            batch->tags[batch->count] = blk >> set_shift;
+            if (++batch->count == BatchSize) {
+                send(*shards[id], batch);
+                open[id] = take(*shards[id]);
+            }
+        }
+    }
+    for (unsigned id = 0; id < num_shards; id++) {
+        send(*shards[id], open[id]);
+        send(*shards[id], nullptr);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    Result result;
+    result.accesses = addrs.size() * repeat;
+    for (const auto &shard : shards) {
+        shard->addTo(result);
+    }
+    return result;
+}
+
+void
+usage(const char *prog)
+{
+    std::fprintf(stderr,
+        "usage: %s [options] [<trace>]\n"
+        "  --sets N          number of sets (default 32768)\n"
+        "  --ways N          associativity (default 16)\n"
+        "  --block-size N    block size in bytes (default 64)\n"
+        "  --ipv LIST        comma separated insertion/promotion vector,\n"
+        "                    ways + 1 entries (default: rescaled paper IPV)\n"
+        "  --shards N        shard threads, a power of 2; 0 simulates\n"
+        "                    sequentially (default: host threads - 1)\n"
+        "  --check           also run sequentially and compare\n"
+        "  --repeat N        replay the trace N times (default 1)\n"
+        "  --synthetic N     accesses to generate without a trace\n"
+        "                    (default 10000000)\n"
+        "  --seed N          seed of the synthetic stream (default 1)\n"
+        "  --footprint N     bytes scanned by the synthetic stream\n"
+        "                    (default 1073741824)\n",
+        prog);
+}
+
+uint64_t
+parseUnsigned(const char *opt, const char *arg)
+{
+    char *end;
+    const unsigned long long v = std::strtoull(arg, &end, 0);
+    if (*arg == '\0' || *end != '\0') {
+        std::fprintf(stderr, "invalid value '%s' for --%s\n", arg, opt);
+        std::exit(1);
+    }
+    return v;
+}
+
+std::vector<unsigned>
+parseList(const char *opt, const char *arg)
+{
+    std::vector<unsigned> values;
+    std::string item;
+    for (const char *p = arg; ; p++) {
+        if (*p == ',' || *p == '\0') {
+            values.push_back(parseUnsigned(opt, item.c_str()));
+            item.clear();
+            if (*p == '\0') {
+                break;
+            }
+        } else {
+            item += *p;
+        }
+    }
+    return values;
+}
+
+void
+printResult(const Result &result)
+{
+    std::printf("accesses          %llu\n",
+                (unsigned long long)result.accesses);
+    std::printf("hits              %llu\n", (unsigned long long)result.hits);
+    std::printf("misses            %llu\n",
+                (unsigned long long)result.misses);
+    std::printf("evictions         %llu\n",
+                (unsigned long long)result.evictions);
+    std::printf("setHash           %016llx\n",
+                (unsigned long long)result.setHash);
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char **argv)
+{
+    Geometry geom;
+    unsigned block_size = 64;
+    const unsigned host_threads = std::thread::hardware_concurrency();
+    unsigned num_shards = host_threads > 2 ?
+        1u << floorLog2(host_threads - 1) : 1;
+    bool check = false;
+    unsigned repeat = 1;
+    uint64_t synthetic = 10000000;
+    uint64_t seed = 1;
+    uint64_t footprint = 1ULL << 30;
+
+    static const struct option long_opts[] = {
+        {"sets", required_argument, nullptr, 's'},
+        {"ways", required_argument, nullptr, 'w'},
+        {"block-size", required_argument, nullptr, 'b'},
+        {"ipv", required_argument, nullptr, 'v'},
+        {"shards", required_argument, nullptr, 'j'},
+        {"check", no_argument, nullptr, 'c'},
+        {"repeat", required_argument, nullptr, 'R'},
+        {"synthetic", required_argument, nullptr, 'n'},
+        {"seed", required_argument, nullptr, 'r'},
+        {"footprint", required_argument, nullptr, 'f'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    int opt_idx;
+    while ((c = getopt_long(argc, argv, "h", long_opts, &opt_idx)) != -1) {
+        const char *name = c == '?' || c == 'h' ? "" :
+            long_opts[opt_idx].name;
+        switch (c) {
+          case 's': geom.numSets = parseUnsigned(name, optarg); break;
+          case 'w': geom.assoc = parseUnsigned(name, optarg); break;
+          case 'b': block_size = parseUnsigned(name, optarg); break;
+          case 'v': geom.ipv = parseList(name, optarg); break;
+          case 'j': num_shards = parseUnsigned(name, optarg); break;
+          case 'c': check = true; break;
+          case 'R': repeat = parseUnsigned(name, optarg); break;
+          case 'n': synthetic = parseUnsigned(name, optarg); break;
+          case 'r': seed = parseUnsigned(name, optarg); break;
+          case 'f': footprint = parseUnsigned(name, optarg); break;
+          default:
+            usage(argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    if (optind < argc - 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (!isPowerOf2(geom.numSets) || !isPowerOf2(block_size)) {
+        std::fprintf(stderr, "sets and block size must be powers of 2\n");
+        return 1;
+    }
+    if (num_shards && (!isPowerOf2(num_shards) ||
+                       num_shards > geom.numSets)) {
+        std::fprintf(stderr, "shards must be a power of 2 no larger than "
+                     "the number of sets\n");
+        return 1;
+    }
+    geom.blockShift = floorLog2(block_size);
+    if (geom.ipv.empty()) {
+        geom.ipv = ReplacementPolicy::lruIpvDefaultIPV(geom.assoc);
+    }
+
+    std::vector<uint64_t> addrs;
+    if (optind == argc - 1) {
+        std::string err;
+        if (!loadAddressStream(argv[optind], addrs, err)) {
+            std::fprintf(stderr, "%s\n", err.c_str());
+            return 1;
+        }
+    } else {
+        synthesizeAddressStream(synthetic, seed, footprint, addrs);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const Result result = num_shards ?
+        runSharded(geom, addrs, repeat, num_shards) :
+        runSequential(geom, addrs, repeat);
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    printResult(result);
+    std::printf("shards            %u\n", num_shards);
+    std::printf("seconds           %.6f\n", elapsed.count());
+    std::printf("accessesPerSecond %.0f\n",
+                elapsed.count() ? result.accesses / elapsed.count() : 0);
+
+    if (check) {
+        const Result expected = runSequential(geom, addrs, repeat);
+        if (expected.hits != result.hits ||
+            expected.misses != result.misses ||
+            expected.evictions != result.evictions ||
+            expected.setHash != result.setHash) {
+            std::printf("check             FAILED\n");
+            printResult(expected);
+            return 1;
+        }
+        std::printf("check             matches sequential run\n");
+    }
+    return 0;
+}
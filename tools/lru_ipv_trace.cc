@@ -0,0 +1,156 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Decoder of the binary event log LRUIPVRP writes with the LruIpv debug
+ * flag on:
+ *
+ *     lru_ipv_trace [--summary] [--set N] <replacement_policy.ipvtrace>
+ *
+ * Prints one line per event, or with --summary the events per operation
+ * and the stack positions blocks were hit and inserted at.
+ */
+
+#include <getopt.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "mem/cache/replacement_policies/lru_ipv_trace.hh"
+
+using namespace ReplacementPolicy;
+
+namespace
+{
+
+void
+usage(const char *prog)
+{
+    std::fprintf(stderr,
+        "usage: %s [options] <trace>\n"
+        "  --summary         print totals instead of every event\n"
+        "  --set N           only look at events of set N\n",
+        prog);
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char **argv)
+{
+    bool summary = false;
+    long long only_set = -1;
+
+    static const struct option long_opts[] = {
+        {"summary", no_argument, nullptr, 'S'},
+        {"set", required_argument, nullptr, 's'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "h", long_opts, nullptr)) != -1) {
+        switch (c) {
+          case 'S': summary = true; break;
+          case 's': only_set = std::strtoll(optarg, nullptr, 0); break;
+          default:
+            usage(argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FILE *file = std::fopen(argv[optind], "rb");
+    if (!file) {
+        std::fprintf(stderr, "cannot open %s\n", argv[optind]);
+        return 1;
+    }
+
+    LRUIPVTraceHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+        std::memcmp(header.magic, lruIpvTraceMagic, sizeof(header.magic)) ||
+        header.version != lruIpvTraceVersion) {
+        std::fprintf(stderr, "%s is not an LRU-IPV trace (version %u)\n",
+                     argv[optind], lruIpvTraceVersion);
+        return 1;
+    }
+
+    std::vector<unsigned long long> op_counts(NumLRUIPVTraceOps + 1);
+    // Per operation, events by the position the block started from; the
+    // last bucket collects invalidated blocks.
+    std::vector<std::vector<unsigned long long>> from_pos(
+        NumLRUIPVTraceOps + 1,
+        std::vector<unsigned long long>(header.numWays + 1));
+
+    std::vector<LRUIPVTraceEvent> events(1 << 16);
+    size_t count;
+    while ((count = std::fread(events.data(), sizeof(LRUIPVTraceEvent),
+                               events.size(), file)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            const LRUIPVTraceEvent &event = events[i];
+            if (only_set >= 0 && event.set != only_set) {
+                continue;
+            }
+            const unsigned op = event.op < NumLRUIPVTraceOps ?
+                unsigned(event.op) : unsigned(NumLRUIPVTraceOps);
+            if (!summary) {
+                std::printf("%-10s set %u way %u %u -> %u\n",
+                            lruIpvTraceOpName(op), event.set, event.way,
+                            event.oldPos, event.newPos);
+                continue;
+            }
+            op_counts[op]++;
+            if (event.oldPos <= header.numWays) {
+                from_pos[op][event.oldPos]++;
+            }
+        }
+    }
+    std::fclose(file);
+
+    if (summary) {
+        std::printf("ways %u\n", header.numWays);
+        for (unsigned op = 0; op <= NumLRUIPVTraceOps; op++) {
+            if (!op_counts[op]) {
+                continue;
+            }
+            std::printf("%-10s %llu\n  from:", lruIpvTraceOpName(op),
+                        op_counts[op]);
+            for (unsigned pos = 0; pos <= header.numWays; pos++) {
+                std::printf(" %llu", from_pos[op][pos]);
+            }
+            std::printf("\n");
+        }
+    }
+    return 0;
+}
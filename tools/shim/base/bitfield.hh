@@ -0,0 +1,45 @@
+/*
+ * Minimal stand-in for gem5's base/bitfield.hh used by the standalone tools.
+ */
+
+#ifndef __SHIM_BASE_BITFIELD_HH__
+#define __SHIM_BASE_BITFIELD_HH__
+
+#include <cstdint>
+
+inline uint64_t
+mask(unsigned nbits)
+{
+    return (nbits >= 64) ? (uint64_t)-1LL : (1ULL << nbits) - 1;
+}
+
+template <class T>
+inline T
+bits(T val, unsigned first, unsigned last)
+{
+    int nbits = first - last + 1;
+    return (val >> last) & mask(nbits);
+}
+
+template <class T>
+inline T
+bits(T val, unsigned bit)
+{
+    return bits(val, bit, bit);
+}
+
+/** Index of the most significant set bit; val must be non-zero. */
+inline int
+findMsbSet(uint64_t val)
+{
+    return 63 - __builtin_clzll(val);
+}
+
+/** Index of the least significant set bit; val must be non-zero. */
+inline int
+findLsbSet(uint64_t val)
+{
+    return __builtin_ctzll(val);
+}
+
+#endif // __SHIM_BASE_BITFIELD_HH__
@@ -0,0 +1,24 @@
+/*
+ * Minimal stand-in for gem5's base/cprintf.hh used by the standalone
+ * tools. Only csprintf() is provided, on top of snprintf.
+ */
+
+#ifndef __SHIM_BASE_CPRINTF_HH__
+#define __SHIM_BASE_CPRINTF_HH__
+
+#include <cstdio>
+#include <string>
+
+#include "base/logging.hh"
+
+template <class... Args>
+std::string
+csprintf(const char *fmt, const Args &...args)
+{
+    const int len = std::snprintf(nullptr, 0, fmt, shim::logArg(args)...);
+    std::string out(len > 0 ? len : 0, '\0');
+    std::snprintf(&out[0], out.size() + 1, fmt, shim::logArg(args)...);
+    return out;
+}
+
+#endif // __SHIM_BASE_CPRINTF_HH__
@@ -0,0 +1,46 @@
+/*
+ * Flag registry of the debug shim, and the flags DTRACE() is used with.
+ */
+
+#include "base/debug.hh"
+
+#include <map>
+
+namespace Debug {
+
+namespace {
+
+std::map<std::string, SimpleFlag *> &
+allFlags()
+{
+    static std::map<std::string, SimpleFlag *> flags;
+    return flags;
+}
+
+} // anonymous namespace
+
+SimpleFlag::SimpleFlag(const char *name, const char *desc)
+    : _name(name), _status(false)
+{
+    (void)desc;
+    allFlags()[_name] = this;
+}
+
+bool
+changeFlag(const char *name, bool value)
+{
+    auto it = allFlags().find(name);
+    if (it == allFlags().end()) {
+        return false;
+    }
+    if (value) {
+        it->second->enable();
+    } else {
+        it->second->disable();
+    }
+    return true;
+}
+
+SimpleFlag LruIpv("LruIpv", "LRU-IPV replacement policy");
+
+} // namespace Debug
@@ -0,0 +1,35 @@
+/*
+ * Stand-in for gem5's base/debug.hh: named flags that DTRACE() tests,
+ * switched on by name with Debug::changeFlag().
+ */
+
+#ifndef __SHIM_BASE_DEBUG_HH__
+#define __SHIM_BASE_DEBUG_HH__
+
+#include <string>
+
+namespace Debug {
+
+class SimpleFlag
+{
+  public:
+    SimpleFlag(const char *name, const char *desc);
+
+    const std::string &name() const { return _name; }
+
+    void enable() { _status = true; }
+    void disable() { _status = false; }
+
+    operator bool() const { return _status; }
+
+  private:
+    const std::string _name;
+    bool _status;
+};
+
+/** Set a flag by name; false if there is no such flag. */
+bool changeFlag(const char *name, bool value);
+
+} // namespace Debug
+
+#endif // __SHIM_BASE_DEBUG_HH__
@@ -0,0 +1,47 @@
+/*
+ * Minimal stand-in for gem5's base/intmath.hh used by the standalone tools.
+ */
+
+#ifndef __SHIM_BASE_INTMATH_HH__
+#define __SHIM_BASE_INTMATH_HH__
+
+#include <cstdint>
+
+template <class T>
+inline bool
+isPowerOf2(const T &n)
+{
+    return n != 0 && (n & (n - 1)) == 0;
+}
+
+template <class T>
+inline int
+floorLog2(T x)
+{
+    int y = -1;
+    uint64_t v = x;
+    while (v) {
+        v >>= 1;
+        y++;
+    }
+    return y;
+}
+
+template <class T>
+inline int
+ceilLog2(const T &n)
+{
+    if (n == 1) {
+        return 0;
+    }
+    return floorLog2(n - (T)1) + 1;
+}
+
+template <class T, class U>
+inline T
+divCeil(const T &a, const U &b)
+{
+    return (a + b - 1) / b;
+}
+
+#endif // __SHIM_BASE_INTMATH_HH__
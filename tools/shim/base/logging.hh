@@ -0,0 +1,76 @@
+/*
+ * Minimal stand-in for gem5's base/logging.hh used by the standalone tools.
+ */
+
+#ifndef __SHIM_BASE_LOGGING_HH__
+#define __SHIM_BASE_LOGGING_HH__
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace shim {
+
+/** Let std::string arguments through to printf-style formats. */
+inline const char *logArg(const std::string &s) { return s.c_str(); }
+
+template <class T>
+inline T logArg(T v) { return v; }
+
+template <class... Args>
+inline void
+logMessage(const char *prefix, const char *fmt, const Args &...args)
+{
+    std::fputs(prefix, stderr);
+    std::fprintf(stderr, fmt, logArg(args)...);
+}
+
+inline void
+logMessage(const char *prefix, const char *fmt)
+{
+    std::fputs(prefix, stderr);
+    std::fputs(fmt, stderr);
+}
+
+} // namespace shim
+
+#define fatal(...) \
+    do { \
+        shim::logMessage("fatal: ", __VA_ARGS__); \
+        std::exit(1); \
+    } while (0)
+
+#define panic(...) \
+    do { \
+        shim::logMessage("panic: ", __VA_ARGS__); \
+        std::abort(); \
+    } while (0)
+
+#define warn(...) \
+    do { \
+        shim::logMessage("warn: ", __VA_ARGS__); \
+        std::fputc('\n', stderr); \
+    } while (0)
+
+#define inform(...) \
+    do { \
+        shim::logMessage("info: ", __VA_ARGS__); \
+        std::fputc('\n', stderr); \
+    } while (0)
+
+#define fatal_if(cond, ...) \
+    do { \
+        if (cond) { \
+            fatal(__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define panic_if(cond, ...) \
+    do { \
+        if (cond) { \
+            panic(__VA_ARGS__); \
+        } \
+    } while (0)
+
+#endif // __SHIM_BASE_LOGGING_HH__
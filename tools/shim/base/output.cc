@@ -0,0 +1,39 @@
+/*
+ * Minimal stand-in for gem5's base/output.cc used by the standalone
+ * tools.
+ */
+
+#include "base/output.hh"
+
+#include <algorithm>
+
+#include "base/logging.hh"
+
+OutputDirectory simout;
+
+OutputStream *
+OutputDirectory::create(const std::string &name, bool binary, bool no_gz)
+{
+    const std::string path = resolve(name);
+    std::ofstream *stream = new std::ofstream(path,
+        binary ? std::ios::out | std::ios::binary | std::ios::trunc :
+                 std::ios::out | std::ios::trunc);
+    fatal_if(!stream->is_open(), "Cannot open file %s\n", path);
+    files.push_back(new OutputStream(name, stream));
+    return files.back();
+}
+
+void
+OutputDirectory::close(OutputStream *file)
+{
+    files.erase(std::find(files.begin(), files.end(), file));
+    delete file->_stream;
+    delete file;
+}
+
+OutputDirectory::~OutputDirectory()
+{
+    while (!files.empty()) {
+        close(files.back());
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * Minimal stand-in for gem5's base/output.hh used by the standalone
+ * tools. Files are created under a directory the tool chooses.
+ */
+
+#ifndef __SHIM_BASE_OUTPUT_HH__
+#define __SHIM_BASE_OUTPUT_HH__
+
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class OutputStream
+{
+  public:
+    OutputStream(const std::string &name, std::ofstream *stream)
+      : _name(name), _stream(stream)
+    {}
+
+    const std::string &name() const { return _name; }
+    std::ostream *stream() const { return _stream; }
+
+  private:
+    friend class OutputDirectory;
+
+    const std::string _name;
+    std::ofstream *_stream;
+};
+
+class OutputDirectory
+{
+  public:
+    OutputDirectory() : dir(".") {}
+
+    /** Closes the files still open, as gem5 does at exit. */
+    ~OutputDirectory();
+
+    void setDirectory(const std::string &d) { dir = d; }
+    const std::string &directory() const { return dir; }
+
+    std::string resolve(const std::string &name) const
+    {
+        return dir + "/" + name;
+    }
+
+    OutputStream *create(const std::string &name, bool binary = false,
+                         bool no_gz = false);
+    void close(OutputStream *file);
+
+  private:
+    std::string dir;
+    std::vector<OutputStream *> files;
+};
+
+extern OutputDirectory simout;
+
+#endif // __SHIM_BASE_OUTPUT_HH__
@@ -0,0 +1,96 @@
+/*
+ * Minimal stand-in for gem5's base/sat_counter.hh used by the standalone
+ * tools. Only the operations the predictors rely on are provided.
+ */
+
+#ifndef __SHIM_BASE_SAT_COUNTER_HH__
+#define __SHIM_BASE_SAT_COUNTER_HH__
+
+#include <cstdint>
+
+#include "base/logging.hh"
+
+template <class T>
+class GenericSatCounter
+{
+  public:
+    GenericSatCounter()
+      : initialVal(0), maxVal(0), counter(0)
+    {}
+
+    explicit GenericSatCounter(unsigned bits, T initial_val = 0)
+      : initialVal(initial_val), maxVal((1ULL << bits) - 1),
+        counter(initial_val)
+    {
+        fatal_if(bits > 8 * sizeof(T),
+                 "Number of bits exceeds counter size\n");
+        fatal_if(initial_val > maxVal,
+                 "Saturating counter's initial value exceeds max value\n");
+    }
+
+    GenericSatCounter &
+    operator++()
+    {
+        if (counter < maxVal) {
+            ++counter;
+        }
+        return *this;
+    }
+
+    GenericSatCounter
+    operator++(int)
+    {
+        GenericSatCounter old_counter = *this;
+        ++*this;
+        return old_counter;
+    }
+
+    GenericSatCounter &
+    operator--()
+    {
+        if (counter > 0) {
+            --counter;
+        }
+        return *this;
+    }
+
+    GenericSatCounter
+    operator--(int)
+    {
+        GenericSatCounter old_counter = *this;
+        --*this;
+        return old_counter;
+    }
+
+    operator T() const { return counter; }
+
+    GenericSatCounter &
+    operator>>=(int shift)
+    {
+        counter >>= shift;
+        return *this;
+    }
+
+    void reset() { counter = initialVal; }
+
+    bool isSaturated() const { return counter == maxVal; }
+
+    T saturate()
+    {
+        const T diff = maxVal - counter;
+        counter = maxVal;
+        return diff;
+    }
+
+  private:
+    T initialVal;
+    T maxVal;
+    T counter;
+};
+
+typedef GenericSatCounter<uint8_t> SatCounter8;
+typedef GenericSatCounter<uint16_t> SatCounter16;
+typedef GenericSatCounter<uint32_t> SatCounter32;
+typedef GenericSatCounter<uint64_t> SatCounter64;
+
+#endif // __SHIM_BASE_SAT_COUNTER_HH__
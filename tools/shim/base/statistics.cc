@@ -0,0 +1,145 @@
+/*
+ * Minimal stand-in for gem5's statistics package used by the standalone
+ * tools.
+ */
+
+#include "base/statistics.hh"
+
+#include <algorithm>
+
+namespace Stats {
+
+Info::Info(Group *parent, const char *name, const char *desc)
+  : name(name), desc(desc)
+{
+    parent->addStat(this);
+}
+
+Group::Group(Group *parent, const char *name)
+  : groupName(name ? name : "")
+{
+    if (parent) {
+        parent->children.push_back(this);
+    }
+}
+
+void
+Group::regStats()
+{
+    for (Group *child : children) {
+        child->regStats();
+    }
+}
+
+void
+Group::dumpStats(std::ostream &os, const std::string &prefix)
+{
+    preDumpStats();
+    const std::string path = groupName.empty() ? prefix :
+        (prefix.empty() ? groupName : prefix + "." + groupName);
+    for (const Info *info : stats) {
+        info->dump(os, path);
+    }
+    for (Group *child : children) {
+        child->dumpStats(os, path);
+    }
+}
+
+void
+Scalar::dump(std::ostream &os, const std::string &prefix) const
+{
+    os << (prefix.empty() ? name : prefix + "." + name) << " "
+       << (uint64_t)count << " # " << desc << "\n";
+}
+
+void
+Vector::dump(std::ostream &os, const std::string &prefix) const
+{
+    const std::string path = prefix.empty() ? name : prefix + "." + name;
+    Counter sum = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        sum += counts[i];
+        if (counts[i] || !(_flags & nozero)) {
+            os << path << "::" << i << " " << (uint64_t)counts[i] << " # "
+               << desc << "\n";
+        }
+    }
+    if (_flags & total) {
+        os << path << "::total " << (uint64_t)sum << " # " << desc << "\n";
+    }
+}
+
+void
+Histogram::sample(Counter val, int number)
+{
+    if (cvec.empty()) {
+        return;
+    }
+    while (val >= bucketSize * cvec.size()) {
+        // Merge pairs of buckets into the lower half.
+        const size_t half = (cvec.size() + 1) / 2;
+        for (size_t i = 0; i < half; i++) {
+            cvec[i] = cvec[2 * i] + (2 * i + 1 < cvec.size() ?
+                                     cvec[2 * i + 1] : 0);
+        }
+        std::fill(cvec.begin() + half, cvec.end(), 0);
+        bucketSize *= 2;
+    }
+    cvec[(size_t)(val / bucketSize)] += number;
+
+    if (!samples || val < minVal) {
+        minVal = val;
+    }
+    if (!samples || val > maxVal) {
+        maxVal = val;
+    }
+    samples += number;
+    sum += val * number;
+}
+
+void
+Histogram::dump(std::ostream &os, const std::string &prefix) const
+{
+    const std::string path = prefix.empty() ? name : prefix + "." + name;
+    os << path << "::samples " << (uint64_t)samples << " # " << desc << "\n";
+    os << path << "::mean " << (samples ? sum / samples : 0) << " # "
+       << desc << "\n";
+    for (size_t i = 0; i < cvec.size(); i++) {
+        os << path << "::" << (uint64_t)(i * bucketSize) << "-"
+           << (uint64_t)((i + 1) * bucketSize - 1) << " "
+           << (uint64_t)cvec[i] << " # " << desc << "\n";
+    }
+    os << path << "::min_value " << (uint64_t)minVal << " # " << desc
+       << "\n";
+    os << path << "::max_value " << (uint64_t)maxVal << " # " << desc
+       << "\n";
+    os << path << "::total " << (uint64_t)samples << " # " << desc << "\n";
+}
+
+namespace
+{
+
+std::vector<std::function<void()>> &
+dumpCallbacks()
+{
+    static std::vector<std::function<void()>> callbacks;
+    return callbacks;
+}
+
+} // anonymous namespace
+
+void
+registerDumpCallback(const std::function<void()> &callback)
+{
+    dumpCallbacks().push_back(callback);
+}
+
+void
+processDumpCallbacks()
+{
+    for (const auto &callback : dumpCallbacks()) {
+        callback();
+    }
+}
+
+} // namespace Stats
@@ -0,0 +1,145 @@
+/*
+ * Minimal stand-in for gem5's base/statistics.hh used by the standalone
+ * tools. Stats register with their group and can be dumped as text.
+ */
+
+#ifndef __SHIM_BASE_STATISTICS_HH__
+#define __SHIM_BASE_STATISTICS_HH__
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace Stats {
+
+typedef uint16_t FlagsType;
+
+/** Print flags, with gem5's values. */
+const FlagsType none = 0x0000;
+const FlagsType total = 0x0010;
+const FlagsType nozero = 0x0100;
+
+class Group;
+
+class Info
+{
+  public:
+    Info(Group *parent, const char *name, const char *desc);
+    virtual ~Info() = default;
+
+    virtual void dump(std::ostream &os, const std::string &prefix) const = 0;
+
+    const std::string name;
+    const std::string desc;
+};
+
+class Group
+{
+  public:
+    explicit Group(Group *parent, const char *name = nullptr);
+    virtual ~Group() = default;
+
+    Group(const Group &) = delete;
+    Group &operator=(const Group &) = delete;
+
+    /** Register the stats of the child groups, as gem5 does. */
+    virtual void regStats();
+    virtual void preDumpStats() {}
+    virtual void resetStats() {}
+
+    void addStat(Info *info) { stats.push_back(info); }
+
+    /** Dump every stat of this group and its children. */
+    void dumpStats(std::ostream &os, const std::string &prefix = "");
+
+  private:
+    std::string groupName;
+    std::vector<Info *> stats;
+    std::vector<Group *> children;
+};
+
+class Scalar : public Info
+{
+  public:
+    Scalar(Group *parent, const char *name, const char *desc)
+      : Info(parent, name, desc), count(0)
+    {}
+
+    Scalar &operator++() { ++count; return *this; }
+    Scalar &operator++(int) { ++count; return *this; }
+    Scalar &operator+=(Counter v) { count += v; return *this; }
+    Scalar &operator=(Counter v) { count = v; return *this; }
+
+    Counter value() const { return count; }
+
+    void dump(std::ostream &os, const std::string &prefix) const override;
+
+  private:
+    Counter count;
+};
+
+/** A vector of counters, sized with init() before use. */
+class Vector : public Info
+{
+  public:
+    Vector(Group *parent, const char *name, const char *desc)
+      : Info(parent, name, desc), _flags(none)
+    {}
+
+    Vector &init(size_t size) { counts.assign(size, 0); return *this; }
+    Vector &flags(FlagsType f) { _flags |= f; return *this; }
+
+    Counter &operator[](size_t index) { return counts[index]; }
+    Counter operator[](size_t index) const { return counts[index]; }
+    size_t size() const { return counts.size(); }
+
+    void dump(std::ostream &os, const std::string &prefix) const override;
+
+  private:
+    std::vector<Counter> counts;
+    FlagsType _flags;
+};
+
+/**
+ * A histogram of non-negative samples that starts with unit buckets and
+ * doubles their width whenever a sample falls past the last one.
+ */
+class Histogram : public Info
+{
+  public:
+    Histogram(Group *parent, const char *name, const char *desc)
+      : Info(parent, name, desc), bucketSize(1), samples(0), sum(0),
+        minVal(0), maxVal(0)
+    {}
+
+    Histogram &init(size_t buckets) { cvec.assign(buckets, 0); return *this; }
+
+    void sample(Counter val, int number = 1);
+
+    Counter size() const { return samples; }
+
+    void dump(std::ostream &os, const std::string &prefix) const override;
+
+  private:
+    std::vector<Counter> cvec;
+    Counter bucketSize;
+    Counter samples;
+    Counter sum;
+    Counter minVal;
+    Counter maxVal;
+};
+
+/** Register a function to run before every stats dump. */
+void registerDumpCallback(const std::function<void()> &callback);
+
+/** Tool-side hook: run the dump callbacks, as a gem5 stats dump would. */
+void processDumpCallbacks();
+
+} // namespace Stats
+
+#define ADD_STAT(n, ...) n(this, #n, __VA_ARGS__)
+
+#endif // __SHIM_BASE_STATISTICS_HH__
@@ -0,0 +1,31 @@
+/*
+ * Minimal stand-in for gem5's base/trace.hh used by the standalone tools.
+ * DPRINTF output is compiled out entirely; DTRACE() tests the flags
+ * switched on with Debug::changeFlag().
+ */
+
+#ifndef __SHIM_BASE_TRACE_HH__
+#define __SHIM_BASE_TRACE_HH__
+
+#include "base/debug.hh"
+
+#define TRACING_ON 1
+
+#define DTRACE(x) (::Debug::x)
+
+namespace shim {
+
+/** Swallow DPRINTF arguments so they still count as used. */
+template <class... Args>
+inline void ignoreArgs(const Args &...) {}
+
+} // namespace shim
+
+#define DPRINTF(x, ...) \
+    do { \
+        if (false) { \
+            shim::ignoreArgs(__VA_ARGS__); \
+        } \
+    } while (0)
+
+#endif // __SHIM_BASE_TRACE_HH__
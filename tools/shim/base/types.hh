@@ -0,0 +1,19 @@
+/*
+ * Minimal stand-in for gem5's base/types.hh used by the standalone tools.
+ */
+
+#ifndef __SHIM_BASE_TYPES_HH__
+#define __SHIM_BASE_TYPES_HH__
+
+#include <cstdint>
+
+typedef uint64_t Addr;
+typedef int16_t ThreadID;
+typedef uint64_t Tick;
+typedef uint64_t InstSeqNum;
+typedef double Counter;
+
+#define ULL(N) ((uint64_t)N##ULL)
+#define LL(N) ((int64_t)N##LL)
+
+#endif // __SHIM_BASE_TYPES_HH__
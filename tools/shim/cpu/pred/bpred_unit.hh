@@ -0,0 +1,46 @@
+/*
+ * Minimal stand-in for gem5's cpu/pred/bpred_unit.hh used by the
+ * standalone tools. Only the direction predictor interface is kept; the
+ * BTB, RAS and prediction history queues live in the tool's driver.
+ */
+
+#ifndef __SHIM_CPU_PRED_BPRED_UNIT_HH__
+#define __SHIM_CPU_PRED_BPRED_UNIT_HH__
+
+#include "base/types.hh"
+#include "params/BranchPredictor.hh"
+#include "sim/sim_object.hh"
+
+/** The tools never look at the instruction, so a null pointer will do. */
+typedef const void *StaticInstPtr;
+
+class BPredUnit : public SimObject
+{
+  public:
+    typedef BranchPredictorParams Params;
+
+    explicit BPredUnit(const Params &p)
+      : SimObject(p), numThreads(p.numThreads),
+        instShiftAmt(p.instShiftAmt)
+    {}
+
+    virtual void uncondBranch(ThreadID tid, Addr pc, void * &bp_history) = 0;
+
+    virtual bool lookup(ThreadID tid, Addr instPC, void * &bp_history) = 0;
+
+    virtual void btbUpdate(ThreadID tid, Addr instPC,
+                           void * &bp_history) = 0;
+
+    virtual void update(ThreadID tid, Addr instPC, bool taken,
+                        void *bp_history, bool squashed,
+                        const StaticInstPtr &inst, Addr corrTarget) = 0;
+
+    virtual void squash(ThreadID tid, void *bp_history) = 0;
+
+  protected:
+    const unsigned numThreads;
+
+    const unsigned instShiftAmt;
+};
+
+#endif // __SHIM_CPU_PRED_BPRED_UNIT_HH__
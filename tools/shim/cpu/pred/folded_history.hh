@@ -0,0 +1,2 @@
+/* Forwards to the predictor sources in BranchPredictor/. */
+#include "../../../../BranchPredictor/folded_history.hh"
@@ -0,0 +1,3 @@
+/*
+ * Stand-in for the generated debug/GSDebug.hh; tracing is compiled out.
+ */
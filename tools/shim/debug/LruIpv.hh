@@ -0,0 +1,15 @@
+/*
+ * Stand-in for the generated debug/LruIpv.hh.
+ */
+
+#ifndef __SHIM_DEBUG_LRU_IPV_HH__
+#define __SHIM_DEBUG_LRU_IPV_HH__
+
+namespace Debug {
+
+class SimpleFlag;
+extern SimpleFlag LruIpv;
+
+} // namespace Debug
+
+#endif // __SHIM_DEBUG_LRU_IPV_HH__
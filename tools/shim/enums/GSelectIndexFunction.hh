@@ -0,0 +1,25 @@
+/*
+ * Stand-in for the generated enums/GSelectIndexFunction.hh.
+ */
+
+#ifndef __SHIM_ENUMS_GSELECTINDEXFUNCTION_HH__
+#define __SHIM_ENUMS_GSELECTINDEXFUNCTION_HH__
+
+namespace Enums {
+
+enum GSelectIndexFunction
+{
+    Concat,
+    Gshare,
+    Skewed,
+    Multiplicative,
+    Num_GSelectIndexFunction
+};
+
+static const char *const GSelectIndexFunctionStrings[] = {
+    "Concat", "Gshare", "Skewed", "Multiplicative"
+};
+
+} // namespace Enums
+
+#endif // __SHIM_ENUMS_GSELECTINDEXFUNCTION_HH__
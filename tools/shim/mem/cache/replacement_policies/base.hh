@@ -0,0 +1,40 @@
+/*
+ * Minimal stand-in for gem5's replacement_policies/base.hh used by the
+ * standalone tools.
+ */
+
+#ifndef __SHIM_MEM_CACHE_REPLACEMENT_POLICIES_BASE_HH__
+#define __SHIM_MEM_CACHE_REPLACEMENT_POLICIES_BASE_HH__
+
+#include <memory>
+#include <vector>
+
+#include "mem/cache/replacement_policies/replaceable_entry.hh"
+#include "params/BaseReplacementPolicy.hh"
+#include "sim/sim_object.hh"
+
+typedef std::vector<ReplaceableEntry*> ReplacementCandidates;
+
+namespace ReplacementPolicy {
+
+class Base : public SimObject
+{
+  public:
+    typedef BaseReplacementPolicyParams Params;
+    Base(const Params &p) : SimObject(p) {}
+    virtual ~Base() = default;
+
+    virtual void invalidate(const std::shared_ptr<ReplacementData>&
+                                                replacement_data) const = 0;
+    virtual void touch(const std::shared_ptr<ReplacementData>&
+                                                replacement_data) const = 0;
+    virtual void reset(const std::shared_ptr<ReplacementData>&
+                                                replacement_data) const = 0;
+    virtual ReplaceableEntry* getVictim(
+                           const ReplacementCandidates& candidates) const = 0;
+    virtual std::shared_ptr<ReplacementData> instantiateEntry() = 0;
+};
+
+} // namespace ReplacementPolicy
+
+#endif // __SHIM_MEM_CACHE_REPLACEMENT_POLICIES_BASE_HH__
@@ -0,0 +1,2 @@
+/* Forwards to the policy sources in CacheReplacementPolicy/. */
+#include "../../../../../CacheReplacementPolicy/lru_ipv.hh"
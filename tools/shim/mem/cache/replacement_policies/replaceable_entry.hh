@@ -0,0 +1,41 @@
+/*
+ * Minimal stand-in for gem5's replaceable_entry.hh used by the
+ * standalone tools.
+ */
+
+#ifndef __SHIM_MEM_CACHE_REPLACEMENT_POLICIES_REPLACEABLE_ENTRY_HH__
+#define __SHIM_MEM_CACHE_REPLACEMENT_POLICIES_REPLACEABLE_ENTRY_HH__
+
+#include <cstdint>
+#include <memory>
+
+namespace ReplacementPolicy {
+
+/** Policy specific replacement data; each policy derives its own. */
+struct ReplacementData {};
+
+} // namespace ReplacementPolicy
+
+class ReplaceableEntry
+{
+  protected:
+    uint32_t _set = 0;
+    uint32_t _way = 0;
+
+  public:
+    virtual ~ReplaceableEntry() = default;
+
+    std::shared_ptr<ReplacementPolicy::ReplacementData> replacementData;
+
+    virtual void
+    setPosition(const uint32_t set, const uint32_t way)
+    {
+        _set = set;
+        _way = way;
+    }
+
+    uint32_t getSet() const { return _set; }
+    uint32_t getWay() const { return _way; }
+};
+
+#endif // __SHIM_MEM_CACHE_REPLACEMENT_POLICIES_REPLACEABLE_ENTRY_HH__
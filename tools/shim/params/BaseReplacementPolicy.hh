@@ -0,0 +1,14 @@
+/*
+ * Stand-in for the generated params/BaseReplacementPolicy.hh.
+ */
+
+#ifndef __SHIM_PARAMS_BASEREPLACEMENTPOLICY_HH__
+#define __SHIM_PARAMS_BASEREPLACEMENTPOLICY_HH__
+
+#include "params/SimObject.hh"
+
+struct BaseReplacementPolicyParams : public SimObjectParams
+{
+};
+
+#endif // __SHIM_PARAMS_BASEREPLACEMENTPOLICY_HH__
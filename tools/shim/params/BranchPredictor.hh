@@ -0,0 +1,20 @@
+/*
+ * Stand-in for the generated params/BranchPredictor.hh. Defaults mirror
+ * BranchPredictor.py.
+ */
+
+#ifndef __SHIM_PARAMS_BRANCHPREDICTOR_HH__
+#define __SHIM_PARAMS_BRANCHPREDICTOR_HH__
+
+#include "params/SimObject.hh"
+
+struct BranchPredictorParams : public SimObjectParams
+{
+    unsigned numThreads = 1;
+    unsigned BTBEntries = 4096;
+    unsigned BTBTagSize = 16;
+    unsigned RASSize = 16;
+    unsigned instShiftAmt = 2;
+};
+
+#endif // __SHIM_PARAMS_BRANCHPREDICTOR_HH__
@@ -0,0 +1,35 @@
+/*
+ * Stand-in for the generated params/GSelectBP.hh. Defaults mirror the
+ * GSelectBP SimObject in BranchPredictor.py.
+ */
+
+#ifndef __SHIM_PARAMS_GSELECTBP_HH__
+#define __SHIM_PARAMS_GSELECTBP_HH__
+
+#include <string>
+
+#include "enums/GSelectIndexFunction.hh"
+#include "params/BranchPredictor.hh"
+
+struct GSelectBPParams : public BranchPredictorParams
+{
+    unsigned PredictorSize = 1024;
+    unsigned PHTCtrBits = 2;
+    unsigned globalHistoryBits = 8;
+    unsigned foldedHistoryBits = 0;
+    Enums::GSelectIndexFunction indexFunction = Enums::Concat;
+    bool threadHashedIndex = false;
+    unsigned taggedWays = 0;
+    unsigned tagBits = 8;
+    unsigned bimodalSize = 1024;
+    bool packedPHT = false;
+    bool specializedKernels = true;
+    unsigned historyPoolSize = 256;
+    unsigned profileEntries = 0;
+    unsigned profileTopN = 64;
+    std::string profileFormat = "csv";
+    bool callLog = false;
+    unsigned callLogBufferSize = 65536;
+};
+
+#endif // __SHIM_PARAMS_GSELECTBP_HH__
@@ -0,0 +1,22 @@
+/*
+ * Stand-in for the generated params/LRUIPVRP.hh.
+ */
+
+#ifndef __SHIM_PARAMS_LRUIPVRP_HH__
+#define __SHIM_PARAMS_LRUIPVRP_HH__
+
+#include <vector>
+
+#include "params/BaseReplacementPolicy.hh"
+
+struct LRUIPVRPParams : public BaseReplacementPolicyParams
+{
+    unsigned numWays = 16;
+    std::vector<unsigned> ipv;
+    std::vector<unsigned> duelingIPVs;
+    unsigned duelingConstituency = 64;
+    unsigned duelingCounterBits = 10;
+    bool compactRecency = false;
+};
+
+#endif // __SHIM_PARAMS_LRUIPVRP_HH__
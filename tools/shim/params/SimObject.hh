@@ -0,0 +1,17 @@
+/*
+ * Stand-in for the generated params/SimObject.hh.
+ */
+
+#ifndef __SHIM_PARAMS_SIMOBJECT_HH__
+#define __SHIM_PARAMS_SIMOBJECT_HH__
+
+#include <string>
+
+struct SimObjectParams
+{
+    std::string name = "system";
+
+    virtual ~SimObjectParams() = default;
+};
+
+#endif // __SHIM_PARAMS_SIMOBJECT_HH__
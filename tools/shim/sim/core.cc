@@ -0,0 +1,34 @@
+/*
+ * Minimal stand-in for gem5's sim/core.cc used by the standalone tools.
+ */
+
+#include "sim/core.hh"
+
+#include <vector>
+
+namespace
+{
+
+std::vector<std::function<void()>> &
+exitCallbacks()
+{
+    static std::vector<std::function<void()>> callbacks;
+    return callbacks;
+}
+
+} // anonymous namespace
+
+void
+registerExitCallback(const std::function<void()> &callback)
+{
+    exitCallbacks().push_back(callback);
+}
+
+void
+processExitCallbacks()
+{
+    for (const auto &callback : exitCallbacks()) {
+        callback();
+    }
+    exitCallbacks().clear();
+}
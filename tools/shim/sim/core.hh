@@ -0,0 +1,18 @@
+/*
+ * Minimal stand-in for gem5's sim/core.hh used by the standalone tools.
+ */
+
+#ifndef __SHIM_SIM_CORE_HH__
+#define __SHIM_SIM_CORE_HH__
+
+#include <functional>
+
+void registerExitCallback(const std::function<void()> &callback);
+
+/**
+ * Tool-side hook: run the exit callbacks, as gem5 does when simulation
+ * ends. Call it while the objects that registered them are still alive.
+ */
+void processExitCallbacks();
+
+#endif // __SHIM_SIM_CORE_HH__
@@ -0,0 +1,82 @@
+/*
+ * Minimal stand-in for gem5's sim/serialize.cc used by the standalone
+ * tools.
+ */
+
+#include "sim/serialize.hh"
+
+#include <fstream>
+
+const char *CheckpointIn::baseFilename = "m5.cpt";
+std::string CheckpointIn::currentDirectory;
+
+CheckpointIn::CheckpointIn(const std::string &cpt_dir)
+    : cptDir(cpt_dir)
+{
+    const std::string file = cptDir + "/" + baseFilename;
+    std::ifstream in(file);
+    fatal_if(!in, "Can't open checkpoint file '%s'\n", file);
+
+    std::string line;
+    std::string section;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == ';' || line[0] == '#') {
+            continue;
+        }
+        if (line[0] == '[') {
+            section = line.substr(1, line.find(']') - 1);
+            continue;
+        }
+        const size_t eq = line.find('=');
+        if (eq != std::string::npos) {
+            sections[section][line.substr(0, eq)] = line.substr(eq + 1);
+        }
+    }
+}
+
+bool
+CheckpointIn::find(const std::string &section, const std::string &entry,
+                   std::string &value) const
+{
+    auto sec = sections.find(section);
+    if (sec == sections.end()) {
+        return false;
+    }
+    auto it = sec->second.find(entry);
+    if (it == sec->second.end()) {
+        return false;
+    }
+    value = it->second;
+    return true;
+}
+
+std::string
+CheckpointIn::setDir(const std::string &name)
+{
+    currentDirectory = name;
+    return currentDirectory;
+}
+
+std::vector<std::string> &
+Serializable::path()
+{
+    static std::vector<std::string> names;
+    return names;
+}
+
+void
+Serializable::ScopedCheckpointSection::pushName(const std::string &name)
+{
+    if (path().empty()) {
+        path().push_back(name);
+    } else {
+        path().push_back(path().back() + "." + name);
+    }
+}
+
+const std::string &
+Serializable::currentSection()
+{
+    static const std::string root;
+    return path().empty() ? root : path().back();
+}
@@ -0,0 +1,215 @@
+/*
+ * Minimal stand-in for gem5's sim/serialize.hh used by the standalone
+ * tools. Checkpoints use the same ini layout as gem5's m5.cpt: a
+ * "[section]" header per object followed by "name=value" lines, with
+ * arrays written as space separated values.
+ */
+
+#ifndef __SHIM_SIM_SERIALIZE_HH__
+#define __SHIM_SIM_SERIALIZE_HH__
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "base/logging.hh"
+
+typedef std::ostream CheckpointOut;
+
+class CheckpointIn
+{
+  public:
+    /** Parse <cpt_dir>/m5.cpt. */
+    explicit CheckpointIn(const std::string &cpt_dir);
+
+    bool find(const std::string &section, const std::string &entry,
+              std::string &value) const;
+
+    const std::string getCptDir() { return cptDir; }
+
+    /** Directory of the checkpoint currently being written. */
+    static std::string dir() { return currentDirectory; }
+    static std::string setDir(const std::string &name);
+
+    static const char *baseFilename;
+
+  private:
+    const std::string cptDir;
+    std::map<std::string, std::map<std::string, std::string>> sections;
+
+    static std::string currentDirectory;
+};
+
+class Serializable
+{
+  protected:
+    class ScopedCheckpointSection
+    {
+      public:
+        ScopedCheckpointSection(CheckpointOut &cp, const std::string &name)
+        {
+            pushName(name);
+            cp << "\n[" << currentSection() << "]\n";
+        }
+
+        ScopedCheckpointSection(CheckpointIn &cp, const std::string &name)
+        {
+            pushName(name);
+        }
+
+        ~ScopedCheckpointSection() { path().pop_back(); }
+
+      private:
+        static void pushName(const std::string &name);
+    };
+
+  public:
+    virtual ~Serializable() {}
+
+    virtual void serialize(CheckpointOut &cp) const = 0;
+    virtual void unserialize(CheckpointIn &cp) = 0;
+
+    /** Serialize under a new "[name]" section. */
+    void serializeSection(CheckpointOut &cp, const std::string &name) const
+    {
+        ScopedCheckpointSection sec(cp, name);
+        serialize(cp);
+    }
+
+    void unserializeSection(CheckpointIn &cp, const std::string &name)
+    {
+        ScopedCheckpointSection sec(cp, name);
+        unserialize(cp);
+    }
+
+    static const std::string &currentSection();
+
+  private:
+    static std::vector<std::string> &path();
+};
+
+namespace shim
+{
+
+template <class T>
+void
+showParam(std::ostream &os, const T &value)
+{
+    os << value;
+}
+
+/** Bytes are written as numbers, not characters. */
+inline void
+showParam(std::ostream &os, const uint8_t &value)
+{
+    os << unsigned(value);
+}
+
+template <class T>
+bool
+parseParam(const std::string &s, T &value)
+{
+    std::istringstream is(s);
+    is >> value;
+    return !is.fail();
+}
+
+inline bool
+parseParam(const std::string &s, uint8_t &value)
+{
+    unsigned v;
+    if (!parseParam(s, v) || v > 0xff) {
+        return false;
+    }
+    value = v;
+    return true;
+}
+
+} // namespace shim
+
+template <class T>
+void
+paramOut(CheckpointOut &os, const std::string &name, const T &param)
+{
+    os << name << "=";
+    shim::showParam(os, param);
+    os << "\n";
+}
+
+template <class T>
+void
+paramIn(CheckpointIn &cp, const std::string &name, T &param)
+{
+    const std::string &section = Serializable::currentSection();
+    std::string str;
+    fatal_if(!cp.find(section, name, str) || !shim::parseParam(str, param),
+             "Can't unserialize '%s:%s'\n", section, name);
+}
+
+/**
+ * Like paramIn() but for entries older checkpoints may lack.
+ * @return Whether the entry was there.
+ */
+template <class T>
+bool
+optParamIn(CheckpointIn &cp, const std::string &name, T &param,
+           bool do_warn = true)
+{
+    const std::string &section = Serializable::currentSection();
+    std::string str;
+    if (!cp.find(section, name, str)) {
+        if (do_warn) {
+            warn("optional parameter %s:%s not present\n", section, name);
+        }
+        return false;
+    }
+    fatal_if(!shim::parseParam(str, param),
+             "Can't unserialize '%s:%s'\n", section, name);
+    return true;
+}
+
+template <class T>
+void
+arrayParamOut(CheckpointOut &os, const std::string &name,
+              const std::vector<T> &param)
+{
+    os << name << "=";
+    for (size_t i = 0; i < param.size(); i++) {
+        if (i) {
+            os << " ";
+        }
+        shim::showParam(os, param[i]);
+    }
+    os << "\n";
+}
+
+template <class T>
+void
+arrayParamIn(CheckpointIn &cp, const std::string &name,
+             std::vector<T> &param)
+{
+    const std::string &section = Serializable::currentSection();
+    std::string str;
+    fatal_if(!cp.find(section, name, str),
+             "Can't unserialize '%s:%s'\n", section, name);
+
+    std::istringstream is(str);
+    std::string token;
+    param.clear();
+    while (is >> token) {
+        T value;
+        fatal_if(!shim::parseParam(token, value),
+                 "Can't unserialize '%s:%s'\n", section, name);
+        param.push_back(value);
+    }
+}
+
+#define SERIALIZE_SCALAR(scalar) paramOut(cp, #scalar, scalar)
+#define UNSERIALIZE_SCALAR(scalar) paramIn(cp, #scalar, scalar)
+#define SERIALIZE_CONTAINER(member) arrayParamOut(cp, #member, member)
+#define UNSERIALIZE_CONTAINER(member) arrayParamIn(cp, #member, member)
+
+#endif // __SHIM_SIM_SERIALIZE_HH__
@@ -0,0 +1,36 @@
+/*
+ * Minimal stand-in for gem5's sim/sim_object.hh used by the standalone
+ * tools. A SimObject is just a named, serializable root stats group.
+ */
+
+#ifndef __SHIM_SIM_SIM_OBJECT_HH__
+#define __SHIM_SIM_SIM_OBJECT_HH__
+
+#include <string>
+
+#include "base/statistics.hh"
+#include "params/SimObject.hh"
+#include "sim/serialize.hh"
+
+class SimObject : public Stats::Group, public Serializable
+{
+  public:
+    typedef SimObjectParams Params;
+
+    explicit SimObject(const Params &p)
+      : Stats::Group(nullptr), _name(p.name)
+    {}
+
+    const std::string &name() const { return _name; }
+
+    /** Called once before simulating, after any checkpoint restore. */
+    virtual void startup() {}
+
+    void serialize(CheckpointOut &cp) const override {}
+    void unserialize(CheckpointIn &cp) override {}
+
+  private:
+    const std::string _name;
+};
+
+#endif // __SHIM_SIM_SIM_OBJECT_HH__
@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A bounded lock-free single-producer single-consumer queue.
+ */
+
+#ifndef __TOOLS_SPSC_QUEUE_HH__
+#define __TOOLS_SPSC_QUEUE_HH__
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "base/intmath.hh"
+
+/**
+ * A ring of slots written by exactly one thread and read by exactly one
+ * other. Each side owns its index and publishes it with a release store;
+ * the other side reads it with an acquire load only when its cached copy
+ * says the ring looks full or empty, so in the steady state neither side
+ * touches the other's cache line.
+ */
+template <class T>
+class SPSCQueue
+{
+  public:
+    /** @param capacity Slots, rounded up to a power of 2. */
+    explicit SPSCQueue(size_t capacity)
+        : slots(size_t(1) << ceilLog2(capacity)), mask(slots.size() - 1)
+    {}
+
+    SPSCQueue(const SPSCQueue &) = delete;
+    SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+    /** Producer side. @return false if the queue is full. */
+    bool
+    tryPush(const T &item)
+    {
+        const size_t tail = producer.index.load(std::memory_order_relaxed);
+        if (tail - producer.cached == slots.size()) {
+            producer.cached = consumer.index.load(std::memory_order_acquire);
+            if (tail - producer.cached == slots.size()) {
+                return false;
+            }
+        }
+        slots[tail & mask] = item;
+        producer.index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer side. @return false if the queue is empty. */
+    bool
+    tryPop(T &item)
+    {
+        const size_t head = consumer.index.load(std::memory_order_relaxed);
+        if (head == consumer.cached) {
+            consumer.cached = producer.index.load(std::memory_order_acquire);
+            if (head == consumer.cached) {
+                return false;
+            }
+        }
+        item = slots[head & mask];
+        consumer.index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+  private:
+    /** One side's index and its last view of the other side's. */
+    struct alignas(64) Side
+    {
+        std::atomic<size_t> index{0};
+        size_t cached = 0;
+    };
+
+    std::vector<T> slots;
+    const size_t mask;
+
+    /** Next slot to write, and the consumer index last seen. */
+    Side producer;
+    /** Next slot to read, and the producer index last seen. */
+    Side consumer;
+};
+
+#endif // __TOOLS_SPSC_QUEUE_HH__
@@ -0,0 +1,143 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A small work-stealing thread pool for the offline tools.
+ */
+
+#include "work_stealing_pool.hh"
+
+WorkStealingPool::WorkStealingPool(unsigned threads)
+{
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+    for (unsigned id = 0; id < threads; id++) {
+        queues.emplace_back(new Queue);
+    }
+    for (unsigned id = 0; id < threads; id++) {
+        workers.emplace_back(&WorkStealingPool::work, this, id);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+void
+WorkStealingPool::run(size_t count,
+                      const std::function<void(size_t, unsigned)> &task)
+{
+    if (count == 0) {
+        return;
+    }
+
+    // Publish the batch under the pool lock so that a worker waking up
+    // late never sees the tasks without the function to run them with.
+    std::unique_lock<std::mutex> guard(lock);
+    for (size_t i = 0; i < count; i++) {
+        Queue &queue = *queues[i % queues.size()];
+        std::lock_guard<std::mutex> queue_guard(queue.lock);
+        queue.tasks.push_back(i);
+    }
+    current = &task;
+    remaining = count;
+    batch++;
+    wake.notify_all();
+
+    // Wait for the workers to leave the batch too, so none of them is
+    // still holding task when the next batch is queued.
+    done.wait(guard, [this] { return remaining == 0 && active == 0; });
+    current = nullptr;
+}
+
+bool
+WorkStealingPool::next(unsigned id, size_t &task)
+{
+    {
+        Queue &own = *queues[id];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); i++) {
+        Queue &victim = *queues[(id + i) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+WorkStealingPool::work(unsigned id)
+{
+    uint64_t seen = 0;
+    while (true) {
+        const std::function<void(size_t, unsigned)> *task_fn;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [&] { return stopping || batch != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = batch;
+            task_fn = current;
+            active++;
+        }
+
+        size_t task;
+        while (task_fn && next(id, task)) {
+            (*task_fn)(task, id);
+            remaining--;
+        }
+
+        std::lock_guard<std::mutex> guard(lock);
+        if (--active == 0 && remaining == 0) {
+            done.notify_all();
+        }
+    }
+}
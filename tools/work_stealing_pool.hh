@@ -0,0 +1,100 @@
+/**
+ * Copyright (c) 2022 Ashish Kumar Rambhatla
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * A small work-stealing thread pool for the offline tools.
+ */
+
+#ifndef __TOOLS_WORK_STEALING_POOL_HH__
+#define __TOOLS_WORK_STEALING_POOL_HH__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Runs batches of independent tasks on a fixed set of threads. Each
+ * worker owns a deque; a batch is dealt round-robin across them, workers
+ * take work from the back of their own deque and, once it is empty,
+ * steal from the front of the others'. Tasks of very different length,
+ * such as evaluating candidates on traces of different size, therefore
+ * keep every thread busy until the batch is done.
+ */
+class WorkStealingPool
+{
+  public:
+    /** @param threads Worker count; 0 uses every hardware thread. */
+    explicit WorkStealingPool(unsigned threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    /**
+     * Call task(i) for every i in [0, count) and wait for all of them.
+     * Tasks must not call run() themselves.
+     *
+     * @param task Called with the task index and the worker index.
+     */
+    void run(size_t count,
+             const std::function<void(size_t, unsigned)> &task);
+
+    unsigned size() const { return workers.size(); }
+
+  private:
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<size_t> tasks;
+    };
+
+    void work(unsigned id);
+    bool next(unsigned id, size_t &task);
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues;
+
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(size_t, unsigned)> *current = nullptr;
+    uint64_t batch = 0;
+    std::atomic<size_t> remaining{0};
+    /** Workers currently inside a batch. */
+    unsigned active = 0;
+    bool stopping = false;
+};
+
+#endif // __TOOLS_WORK_STEALING_POOL_HH__